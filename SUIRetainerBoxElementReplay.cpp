@@ -0,0 +1,28 @@
+#include "SUIRetainerBoxElementReplay.h"
+#include "Rendering/DrawElements.h"
+
+void SUIRetainerBoxElementReplay::Construct(const FArguments& InArgs)
+{
+	Offset = FVector2D::ZeroVector;
+}
+
+void SUIRetainerBoxElementReplay::SetRenderData(const TSharedPtr<FSlateRenderDataHandle, ESPMode::ThreadSafe>& InRenderData, const FVector2D& InOffset)
+{
+	RenderData = InRenderData;
+	Offset = InOffset;
+}
+
+int32 SUIRetainerBoxElementReplay::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	if (RenderData.IsValid())
+	{
+		FSlateDrawElement::MakeCachedBuffer(OutDrawElements, LayerId, RenderData, Offset);
+	}
+
+	return LayerId;
+}
+
+FVector2D SUIRetainerBoxElementReplay::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D::ZeroVector;
+}
\ No newline at end of file
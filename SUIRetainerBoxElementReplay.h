@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+
+class FSlateRenderDataHandle;
+
+/**
+ * Draws render data cached from an earlier paint of a retainer's content, offset to where the content is now,
+ * so the retained surface can be drawn again without painting the widgets that made it.
+ */
+class UI_API SUIRetainerBoxElementReplay : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SUIRetainerBoxElementReplay)
+	{
+		_Visibility = EVisibility::HitTestInvisible;
+	}
+	SLATE_END_ARGS()
+
+	/** Constructor */
+	void Construct(const FArguments& InArgs);
+
+	/** Sets the render data to draw, and the offset from where it was painted. */
+	void SetRenderData(const TSharedPtr<FSlateRenderDataHandle, ESPMode::ThreadSafe>& InRenderData, const FVector2D& InOffset);
+
+protected:
+	// SWidget interface
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+	// End SWidget interface
+
+private:
+	mutable TSharedPtr<FSlateRenderDataHandle, ESPMode::ThreadSafe> RenderData;
+	FVector2D Offset;
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "SUIRetainerBoxOcclusionCheck.h"
+
+void SUIRetainerBoxOcclusionCheck::Construct(const FArguments& InArgs)
+{
+	OnCheck = InArgs._OnCheck;
+}
+
+int32 SUIRetainerBoxOcclusionCheck::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	OnCheck.ExecuteIfBound(Args, AllottedGeometry);
+
+	return LayerId;
+}
+
+FVector2D SUIRetainerBoxOcclusionCheck::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D::ZeroVector;
+}
\ No newline at end of file
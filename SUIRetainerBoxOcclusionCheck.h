@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+
+DECLARE_DELEGATE_TwoParams(FOnUIRetainerBoxOcclusionCheck, const FPaintArgs&, const FGeometry&);
+
+/**
+ * Queued as a deferred paint by a retainer that skipped drawing because it was covered last frame.  Deferred
+ * paints run once everything else in the window has been painted, so the retainer can check it's still
+ * covered this frame, and draw if not, before the surface it already painted is rendered.
+ */
+class UI_API SUIRetainerBoxOcclusionCheck : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SUIRetainerBoxOcclusionCheck)
+	{
+		_Visibility = EVisibility::HitTestInvisible;
+	}
+		SLATE_EVENT(FOnUIRetainerBoxOcclusionCheck, OnCheck)
+	SLATE_END_ARGS()
+
+	/** Constructor */
+	void Construct(const FArguments& InArgs);
+
+protected:
+	// SWidget interface
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+	// End SWidget interface
+
+private:
+	FOnUIRetainerBoxOcclusionCheck OnCheck;
+};
\ No newline at end of file
@@ -3,9 +3,21 @@
 #include "UObject/Package.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include "Engine/Texture2D.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Engine/World.h"
 #include "Layout/WidgetCaching.h"
+#include "Widgets/Layout/SWidgetSwitcher.h"
+#include "UIRetainerBoxReadback.h"
+#include "UIRetainerTraceRecorder.h"
+#include "UIRetainerTimeline.h"
+#include "SUIRetainerBoxElementReplay.h"
+#include "SUIRetainerBoxOcclusionCheck.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/Compression.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
 
 DECLARE_CYCLE_STAT(TEXT("Retainer Widget Tick"), STAT_SlateRetainerWidgetTick, STATGROUP_Slate);
 DECLARE_CYCLE_STAT(TEXT("Retainer Widget Paint"), STAT_SlateRetainerWidgetPaint, STATGROUP_Slate);
@@ -22,6 +34,22 @@ FAutoConsoleVariableRef EnableUIRetainedRendering(
 	TEXT("Whether to attempt to render things in SUIRetainerBoxWidgets to render targets first.")
 );
 
+/** True if invalidations from content that can't change the retained pixels should be ignored. */
+int32 GFilterUIRetainerInvalidations = 1;
+FAutoConsoleVariableRef FilterUIRetainerInvalidations(
+	TEXT("Slate.FilterUIRetainerInvalidations"),
+	GFilterUIRetainerInvalidations,
+	TEXT("Whether SUIRetainerBoxWidgets ignore invalidations from hidden content.")
+);
+
+/** True if retainers completely covered by opaque retainers should stop redrawing. */
+int32 GEnableUIRetainerOcclusion = 1;
+FAutoConsoleVariableRef EnableUIRetainerOcclusion(
+	TEXT("Slate.EnableUIRetainerOcclusion"),
+	GEnableUIRetainerOcclusion,
+	TEXT("Whether SUIRetainerBoxWidgets covered by opaque retainers painted above them skip redrawing.")
+);
+
 static bool IsRetainedRenderingEnabled()
 {
 	return GEnableUIRetainedRendering != 0;
@@ -40,6 +68,29 @@ FAutoConsoleVariableRef DeferUIRetainedRenderingRT(
 	GDeferUIRetainedRenderingRenderThread,
 	TEXT("Whether or not to defer retained rendering to happen at the same time as the rest of slate render thread work"));
 
+/**
+ * Creates or resizes the render target resource without flushing rendering commands.  When a new resource is
+ * created the fence completes once the rendering thread has actually created it.  Resizes are queued ahead of
+ * any draw into the target, so they never need waiting on.
+ */
+static void BeginCreateRetainerSurface(UTextureRenderTarget2D* RenderTarget, uint32 Width, uint32 Height, FRenderCommandFence& CreationFence)
+{
+	if (RenderTarget->GameThread_GetRenderTargetResource() && RenderTarget->OverrideFormat == PF_B8G8R8A8)
+	{
+		RenderTarget->ResizeTarget(Width, Height);
+	}
+	else
+	{
+		RenderTarget->SizeX = Width;
+		RenderTarget->SizeY = Height;
+		RenderTarget->OverrideFormat = PF_B8G8R8A8;
+		RenderTarget->bForceLinearGamma = false;
+		RenderTarget->UpdateResource();
+
+		CreationFence.BeginFence();
+	}
+}
+
 class FUIRetainerBoxWidgetRenderingResources : public FDeferredCleanupInterface, public FGCObject
 {
 public:
@@ -47,6 +98,8 @@ public:
 		: WidgetRenderer(nullptr)
 		, RenderTarget(nullptr)
 		, DynamicEffect(nullptr)
+		, BakedSurface(nullptr)
+		, RestoredSurface(nullptr)
 	{}
 
 	~FUIRetainerBoxWidgetRenderingResources()
@@ -63,16 +116,140 @@ public:
 	{
 		Collector.AddReferencedObject(RenderTarget);
 		Collector.AddReferencedObject(DynamicEffect);
+		Collector.AddReferencedObject(BakedSurface);
+		Collector.AddReferencedObject(RestoredSurface);
+		Collector.AddReferencedObjects(TileTargets);
 	}
 public:
 	FWidgetRenderer* WidgetRenderer;
 	UTextureRenderTarget2D* RenderTarget;
 	UMaterialInstanceDynamic* DynamicEffect;
+	UTexture2D* BakedSurface;
+
+	/** The evicted surface brought back from system memory. */
+	UTexture2D* RestoredSurface;
+
+	/** The front and back render targets of every tile when redrawing tiled. */
+	TArray<UTextureRenderTarget2D*> TileTargets;
+};
+
+/**
+ * A surface compressed for eviction or decompressed for a restore on a worker thread, collected by the game thread
+ * when done.
+ */
+struct FUIRetainerBoxEvictionJob
+{
+	int32 Serial = 0;
+	bool bRestore = false;
+	FIntPoint Size = FIntPoint::ZeroValue;
+	TArray<FColor> Pixels;
+	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> CompressedData;
+	double StartTime = 0.0;
+	double WorkMs = 0.0;
+	FThreadSafeBool bDone;
+};
+
+typedef TSharedRef<FUIRetainerBoxEvictionJob, ESPMode::ThreadSafe> FUIRetainerBoxEvictionJobRef;
+
+/** Identifies retained content that can be drawn once and shared between several retainers. */
+struct FUIRetainerBoxSurfaceKey
+{
+	FUIRetainerBoxSurfaceKey(FName InName, FIntPoint InSize, int32 InContentVersion, bool bInWriteContentInGammaSpace)
+		: Name(InName)
+		, Size(InSize)
+		, ContentVersion(InContentVersion)
+		, bWriteContentInGammaSpace(bInWriteContentInGammaSpace)
+	{}
+
+	bool operator==(const FUIRetainerBoxSurfaceKey& Other) const
+	{
+		return Name == Other.Name && Size == Other.Size && ContentVersion == Other.ContentVersion && bWriteContentInGammaSpace == Other.bWriteContentInGammaSpace;
+	}
+
+	friend uint32 GetTypeHash(const FUIRetainerBoxSurfaceKey& Key)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Key.Name), GetTypeHash(Key.Size));
+		Hash = HashCombine(Hash, GetTypeHash(Key.ContentVersion));
+		return HashCombine(Hash, GetTypeHash(Key.bWriteContentInGammaSpace));
+	}
+
+	FName Name;
+	FIntPoint Size;
+	int32 ContentVersion;
+	bool bWriteContentInGammaSpace;
+};
+
+/**
+ * A render target shared by every retainer with the same surface key.  Only one of the retainers redraws
+ * it in any given frame, the rest composite the result.
+ */
+class FUIRetainerBoxSharedSurface : public FGCObject
+{
+public:
+	static TSharedRef<FUIRetainerBoxSharedSurface> FindOrCreate(const FUIRetainerBoxSurfaceKey& InKey)
+	{
+		if (TWeakPtr<FUIRetainerBoxSharedSurface>* ExistingSurface = Surfaces.Find(InKey))
+		{
+			if (TSharedPtr<FUIRetainerBoxSharedSurface> PinnedSurface = ExistingSurface->Pin())
+			{
+				return PinnedSurface.ToSharedRef();
+			}
+		}
+
+		TSharedRef<FUIRetainerBoxSharedSurface> NewSurface = MakeShareable(new FUIRetainerBoxSharedSurface(InKey));
+		Surfaces.Add(InKey, NewSurface);
+		return NewSurface;
+	}
+
+	~FUIRetainerBoxSharedSurface()
+	{
+		Surfaces.Remove(Key);
+	}
+
+	/** FGCObject interface */
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override
+	{
+		Collector.AddReferencedObject(RenderTarget);
+	}
+
+public:
+	FUIRetainerBoxSurfaceKey Key;
+	UTextureRenderTarget2D* RenderTarget;
+
+	/** The frame the shared content was last drawn on. */
+	uint64 LastDrawnFrame;
+
+	/** Completes once the render target has been created on the rendering thread. */
+	FRenderCommandFence CreationFence;
+
+private:
+	FUIRetainerBoxSharedSurface(const FUIRetainerBoxSurfaceKey& InKey)
+		: Key(InKey)
+		, RenderTarget(NewObject<UTextureRenderTarget2D>())
+		, LastDrawnFrame(MAX_uint64)
+	{
+		RenderTarget->ClearColor = FLinearColor::Transparent;
+		RenderTarget->TargetGamma = !Key.bWriteContentInGammaSpace ? 0.f : 1.f;
+		RenderTarget->SRGB = !Key.bWriteContentInGammaSpace;
+
+		// Never flush here, the first use of a key happens while painting.  Draws queued after this are
+		// ordered after the creation on the rendering thread, so only async retainers wait on the fence.
+		BeginCreateRetainerSurface(RenderTarget, Key.Size.X, Key.Size.Y, CreationFence);
+	}
+
+	static TMap<FUIRetainerBoxSurfaceKey, TWeakPtr<FUIRetainerBoxSharedSurface>> Surfaces;
 };
 
+TMap<FUIRetainerBoxSurfaceKey, TWeakPtr<FUIRetainerBoxSharedSurface>> FUIRetainerBoxSharedSurface::Surfaces;
+
 TArray<SUIRetainerBoxWidget*, TInlineAllocator<3>> SUIRetainerBoxWidget::Shared_WaitingToRender;
 int32 SUIRetainerBoxWidget::Shared_MaxRetainerWorkPerFrame(0);
+bool SUIRetainerBoxWidget::Shared_MeasureRedrawTimings(false);
 TFrameValue<int32> SUIRetainerBoxWidget::Shared_RetainerWorkThisFrame(0);
+TArray<SUIRetainerBoxWidget::FOccluder> SUIRetainerBoxWidget::Shared_OccludersThisFrame;
+TArray<SUIRetainerBoxWidget::FOccluder> SUIRetainerBoxWidget::Shared_OccludersLastFrame;
+uint64 SUIRetainerBoxWidget::Shared_OccluderFrame(0);
+TFrameValue<int32> SUIRetainerBoxWidget::Shared_PaintOrderThisFrame(0);
 
 
 SUIRetainerBoxWidget::SUIRetainerBoxWidget()
@@ -95,11 +272,67 @@ SUIRetainerBoxWidget::~SUIRetainerBoxWidget()
 	BeginCleanup(RenderingResources);
 
 	Shared_WaitingToRender.Remove(this);
+
+	if (Group.IsValid())
+	{
+		Group->RemoveMember(this);
+	}
+
+	auto IsThisRetainer = [this](const FOccluder& Occluder) { return Occluder.Retainer == this; };
+	Shared_OccludersThisFrame.RemoveAll(IsThisRetainer);
+	Shared_OccludersLastFrame.RemoveAll(IsThisRetainer);
+
+	if (RecordedRenderData.IsValid() && FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Get().GetRenderer()->ReleaseCachingResourcesFor(this);
+	}
+
+	if (FUIRetainerTraceRecorder::IsRecording())
+	{
+		FUIRetainerTraceRecorder::Get().ForgetRetainer(this);
+	}
+
+	if (FUIRetainerTimeline::IsEnabled())
+	{
+		FUIRetainerTimeline::Get().ForgetRetainer(this);
+	}
+}
+
+bool SUIRetainerBoxWidget::ShouldMeasureTimings()
+{
+	return Shared_MeasureRedrawTimings || FUIRetainerTimeline::IsEnabled() || FUIRetainerTraceRecorder::IsRecording();
+}
+
+bool SUIRetainerBoxWidget::ShouldWriteContentInGammaSpace() const
+{
+	return ColourSpace == EUIRetainerBoxColourSpace::sRGB || !bDynamicMaterialInUse;
+}
+
+UTextureRenderTarget2D* SUIRetainerBoxWidget::GetRenderTarget() const
+{
+	return SharedSurface.IsValid() ? SharedSurface->RenderTarget : RenderingResources->RenderTarget;
+}
+
+bool SUIRetainerBoxWidget::IsContentHitTestable() const
+{
+	return GetVisibility().AreChildrenHitTestVisible();
+}
+
+bool SUIRetainerBoxWidget::IsSurfacePending() const
+{
+	return SharedSurface.IsValid() ? !SharedSurface->CreationFence.IsFenceComplete() : !SurfaceCreationFence.IsFenceComplete();
 }
 
 void SUIRetainerBoxWidget::UpdateWidgetRenderer()
 {
-	const bool bWriteContentInGammaSpace = ColourSpace == EUIRetainerBoxColourSpace::sRGB || !bDynamicMaterialInUse;
+	const bool bWriteContentInGammaSpace = ShouldWriteContentInGammaSpace();
+
+	// Shared surfaces are keyed on the gamma settings, so pick up a matching one on the next draw.
+	if (SharedSurface.IsValid() && SharedSurface->Key.bWriteContentInGammaSpace != bWriteContentInGammaSpace)
+	{
+		ReleaseSharedSurface();
+		RequestRender();
+	}
 
 	if (!RenderingResources->WidgetRenderer)
 	{
@@ -113,13 +346,25 @@ void SUIRetainerBoxWidget::UpdateWidgetRenderer()
 	WidgetRenderer->SetIsPrepassNeeded(false);
 	WidgetRenderer->SetClearHitTestGrid(false);
 
-	// Update the render target to match the current gamma rendering preferences.
+	// Update the render target to match the current gamma rendering preferences.  Recreating the resource is
+	// expensive and loses what was drawn, so only do it when the settings actually change.
+	const bool bGammaChanged = RenderTarget && (RenderTarget->SRGB != !bWriteContentInGammaSpace || RenderTarget->TargetGamma != (!bWriteContentInGammaSpace ? 0.f : 1.f));
 
-	if (RenderTarget)
+	if (bGammaChanged)
 	{
 		RenderTarget->TargetGamma = !bWriteContentInGammaSpace ? 0.f : 1.f;
 		RenderTarget->SRGB = !bWriteContentInGammaSpace;
 		RenderTarget->UpdateResource();
+
+		// Updating the resource loses what was drawn, but the content itself hasn't changed.
+		RequestReplay();
+	}
+
+	// Tiles are created with the gamma settings at the time, so start over on new ones.
+	if (bGammaChanged && Tiles.Num() > 0)
+	{
+		ReleaseTiles();
+		RequestRender();
 	}
 }
 
@@ -127,6 +372,7 @@ void SUIRetainerBoxWidget::Construct(const FArguments& InArgs)
 {
 	FSlateApplicationBase::Get().OnGlobalInvalidate().AddSP(this, &SUIRetainerBoxWidget::OnGlobalInvalidate);
 
+	StatName = InArgs._StatId;
 	STAT(MyStatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_Slate>(InArgs._StatId);)
 
 	UTextureRenderTarget2D* RenderTarget = NewObject<UTextureRenderTarget2D>();
@@ -142,6 +388,9 @@ void SUIRetainerBoxWidget::Construct(const FArguments& InArgs)
 
 	Window->SetShouldResolveDeferred(false);
 
+	OcclusionCheck = SNew(SUIRetainerBoxOcclusionCheck)
+		.OnCheck(this, &SUIRetainerBoxWidget::ResolveOcclusion);
+
 	UpdateWidgetRenderer();
 
 	MyWidget = InArgs._Content.Widget;
@@ -153,12 +402,11 @@ void SUIRetainerBoxWidget::Construct(const FArguments& InArgs)
 	PhaseCount = InArgs._PhaseCount;
 
 	LastDrawTime = FApp::GetCurrentTime();
-	LastTickedFrame = 0;
 
 	bEnableUIRetainedRenderingDesire = true;
 	bEnableUIRetainedRendering = false;
 
-	bRenderRequested = true;
+	ScheduleState.bRenderRequested = true;
 
 	RootCacheNode = nullptr;
 	LastUsedCachedNodeIndex = 0;
@@ -235,6 +483,7 @@ void SUIRetainerBoxWidget::SetContent(const TSharedRef< SWidget >& InContent)
 {
 	MyWidget = InContent;
 	Window->SetContent(InContent);
+	bContentDirty = true;
 }
 
 UMaterialInstanceDynamic* SUIRetainerBoxWidget::GetEffectMaterial() const
@@ -259,7 +508,7 @@ void SUIRetainerBoxWidget::SetEffectMaterial(UMaterialInterface* EffectMaterial)
 	else
 	{
 		RenderingResources->DynamicEffect = nullptr;
-		SurfaceBrush.SetResourceObject(RenderingResources->RenderTarget);
+		SurfaceBrush.SetResourceObject(GetRenderTarget());
 		bDynamicMaterialInUse = false;
 	}
 
@@ -278,259 +527,1618 @@ void SUIRetainerBoxWidget::SetWorld(UWorld* World)
 
 void SUIRetainerBoxWidget::SetColourSpace(EUIRetainerBoxColourSpace InColourSpace)
 {
-	ColourSpace = InColourSpace;
-}
-
-FChildren* SUIRetainerBoxWidget::GetChildren()
-{
-	if (bEnableUIRetainedRendering)
-	{
-		return &EmptyChildSlot;
-	}
-	else
+	if (ColourSpace != InColourSpace)
 	{
-		return SCompoundWidget::GetChildren();
+		ColourSpace = InColourSpace;
+		UpdateWidgetRenderer();
 	}
 }
 
-bool SUIRetainerBoxWidget::ComputeVolatility() const
+void SUIRetainerBoxWidget::SetBakedSurface(UTexture2D* InBakedSurface, bool bInFrozen)
 {
-	return true;
-}
+	RenderingResources->BakedSurface = InBakedSurface;
+	bBakedSurfaceFrozen = InBakedSurface && bInFrozen;
 
-FCachedWidgetNode* SUIRetainerBoxWidget::CreateCacheNode() const
-{
-	// If the node pool is empty, allocate a few
-	if (LastUsedCachedNodeIndex >= NodePool.Num())
+	// Frozen content is never built, even if it was waiting on the baked surface to load.
+	if (bBakedSurfaceFrozen)
 	{
-		for (int32 i = 0; i < 10; i++)
-		{
-			NodePool.Add(new FCachedWidgetNode());
-		}
+		DeferredContentBuilder = nullptr;
 	}
 
-	// Return one of the preallocated nodes and increment the next node index.
-	FCachedWidgetNode* NewNode = NodePool[LastUsedCachedNodeIndex];
-	++LastUsedCachedNodeIndex;
+	// The desired size is in slate units, not pixels at whatever scale the surface was baked at.
+	const UUIRetainerBoxBakeData* BakeData = InBakedSurface ? InBakedSurface->GetAssetUserData<UUIRetainerBoxBakeData>() : nullptr;
+	const float BakeScale = BakeData && BakeData->BakeScale > 0.f ? BakeData->BakeScale : 1.f;
 
-	return NewNode;
-}
+	BakedSurfaceBrush.SetResourceObject(InBakedSurface);
+	BakedSurfaceBrush.ImageSize = InBakedSurface ? FVector2D(InBakedSurface->GetSizeX(), InBakedSurface->GetSizeY()) / BakeScale : FVector2D::ZeroVector;
 
-void SUIRetainerBoxWidget::InvalidateWidget(SWidget* InvalidateWidget)
-{
-	if (RenderOnInvalidation)
-	{
-		bRenderRequested = true;
-	}
+	bBakedSurfaceLoading = false;
+	Invalidate(EInvalidateWidget::Layout);
 }
 
-void SUIRetainerBoxWidget::SetRenderingPhase(int32 InPhase, int32 InPhaseCount)
+void SUIRetainerBoxWidget::SetBakedSurfaceLoading()
 {
-	Phase = InPhase;
-	PhaseCount = InPhaseCount;
+	bBakedSurfaceLoading = true;
 }
 
-void SUIRetainerBoxWidget::RequestRender()
+void SUIRetainerBoxWidget::SetOpaqueContent(bool bInOpaqueContent)
 {
-	bRenderRequested = true;
+	bOpaqueContent = bInOpaqueContent;
 }
 
-bool SUIRetainerBoxWidget::PaintRetainedContent(const FPaintArgs& Args, const FGeometry& AllottedGeometry)
+bool SUIRetainerBoxWidget::IsOccluded(const TArray<FOccluder>& Occluders, const FHittestGrid* PaintGrid, const FSlateRect& VisibleRect, int32 PaintOrder) const
 {
-	if (RenderOnPhase)
+	if (!GEnableUIRetainerOcclusion)
 	{
-		if (LastTickedFrame != GFrameCounter && (GFrameCounter % PhaseCount) == Phase)
-		{
-			bRenderRequested = true;
-		}
+		return false;
 	}
 
-	if (Shared_MaxRetainerWorkPerFrame > 0)
+	// Only a single rect covering all of us counts, overlapping coverage from several isn't combined.
+	for (const FOccluder& Occluder : Occluders)
 	{
-		if (Shared_RetainerWorkThisFrame.TryGetValue(0) > Shared_MaxRetainerWorkPerFrame)
+		if (Occluder.Retainer != this &&
+			Occluder.PaintGrid == PaintGrid &&
+			Occluder.PaintOrder > PaintOrder &&
+			Occluder.Rect.ContainsPoint(VisibleRect.GetTopLeft()) &&
+			Occluder.Rect.ContainsPoint(VisibleRect.GetBottomRight()))
 		{
-			Shared_WaitingToRender.AddUnique(this);
-			return false;
+			return true;
 		}
 	}
 
-	const FPaintGeometry PaintGeometry = AllottedGeometry.ToPaintGeometry();
-	const FVector2D RenderSize = PaintGeometry.GetLocalSize() * PaintGeometry.GetAccumulatedRenderTransform().GetMatrix().GetScale().GetVector();
+	return false;
+}
 
-	if (RenderSize != PreviousRenderSize)
+void SUIRetainerBoxWidget::ResolveOcclusion(const FPaintArgs& Args, const FGeometry& AllottedGeometry)
+{
+	// Last frame's occluder may have closed or moved, or the paint order changed with the tree.  Everything
+	// else has been painted by now, so check against this frame's occluders, whose paint order matches ours.
+	if (!bOccluded)
 	{
-		PreviousRenderSize = RenderSize;
-		bRenderRequested = true;
+		return;
 	}
 
-	if (bRenderRequested)
+	// Only this frame's event is recorded here, one left over from a frame that never resolved is dropped.
+	const bool bRecordOccludedEvent = bOccludedEventPending && PendingOccludedInput.Frame == GFrameCounter;
+	bOccludedEventPending = false;
+
+	if (IsOccluded(Shared_OccludersThisFrame, &Args.GetGrid(), OccludedRect, OccludedPaintOrder))
 	{
-		// In order to get material parameter collections to function properly, we need the current world's Scene
-		// properly propagated through to any widgets that depend on that functionality. The SceneViewport and RetainerWidget the 
-		// only location where this information exists in Slate, so we push the current scene onto the current
-		// Slate application so that we can leverage it in later calls.
-		UWorld* TickWorld = OuterWorld.Get();
-		if (TickWorld && TickWorld->Scene && IsInGameThread())
+		if (bRecordOccludedEvent)
 		{
-			FSlateApplication::Get().GetRenderer()->RegisterCurrentScene(TickWorld->Scene);
+			FUIRetainerScheduleResult OccludedResult;
+			OccludedResult.Decision = EUIRetainerRedrawDecision::Occluded;
+			RecordScheduleEvent(PendingOccludedInput, bPendingOccludedRequested, OccludedResult, false, 0.0, 0.0, PendingOccludedRenderSize);
 		}
-		else if (IsInGameThread())
-		{
-			FSlateApplication::Get().GetRenderer()->RegisterCurrentScene(nullptr);
-		}
-
-		// Update the number of retainers we've drawn this frame.
-		Shared_RetainerWorkThisFrame = Shared_RetainerWorkThisFrame.TryGetValue(0) + 1;
-
-		LastTickedFrame = GFrameCounter;
-		const double TimeSinceLastDraw = FApp::GetCurrentTime() - LastDrawTime;
+		return;
+	}
 
-		const uint32 RenderTargetWidth = FMath::RoundToInt(RenderSize.X);
-		const uint32 RenderTargetHeight = FMath::RoundToInt(RenderSize.Y);
+	// The surface painted earlier this frame is only sampled when the window is rendered, so drawing it now
+	// still shows up this frame.  Painting again records the retainer's event for the frame.
+	bOccluded = false;
+	RequestRender();
 
-		const FVector2D ViewOffset = PaintGeometry.DrawPosition.RoundToVector();
+	if (!bBakedSurfaceFrozen && !DeferredContentBuilder && IsAnythingVisibleToRender())
+	{
+		PaintRetainedContent(Args, AllottedGeometry);
+	}
+}
 
-		// Keep the visibilities the same, the proxy window should maintain the same visible/non-visible hit-testing of the retainer.
-		Window->SetVisibility(GetVisibility());
+void SUIRetainerBoxWidget::SetTransformTolerance(bool bInTransformTolerant, float InReferenceScale, float InQualityBand)
+{
+	bTransformTolerant = bInTransformTolerant;
+	TransformReferenceScale = FMath::Max(InReferenceScale, 0.f);
+	TransformQualityBand = FMath::Clamp(InQualityBand, 0.f, 1.f);
+	PeakTransformScale = 0.f;
+	MaxTransformScale = 0.f;
+	LastTransformScale = 0.f;
+}
 
-		// Need to prepass.
-		Window->SlatePrepass(AllottedGeometry.Scale);
+float SUIRetainerBoxWidget::ChooseTransformScale(float CurrentScale)
+{
+	if (TransformReferenceScale > 0.f)
+	{
+		// Leave the band around the reference and the surface is too blurry or too aliased, draw at the real scale.
+		const bool bInsideBand =
+			CurrentScale >= TransformReferenceScale * (1.f - TransformQualityBand) &&
+			CurrentScale <= TransformReferenceScale * (1.f + TransformQualityBand);
 
-		// Reset the cached node pool index so that we effectively reset the pool.
-		LastUsedCachedNodeIndex = 0;
-		RootCacheNode = nullptr;
+		return bInsideBand ? TransformReferenceScale : CurrentScale;
+	}
 
-		UTextureRenderTarget2D* RenderTarget = RenderingResources->RenderTarget;
-		FWidgetRenderer* WidgetRenderer = RenderingResources->WidgetRenderer;
+	MaxTransformScale = FMath::Max(MaxTransformScale, CurrentScale);
 
-		if (RenderTargetWidth != 0 && RenderTargetHeight != 0)
-		{
-			if (MyWidget->GetVisibility().IsVisible())
-			{
-				if (RenderTarget->GetSurfaceWidth() != RenderTargetWidth ||
-					RenderTarget->GetSurfaceHeight() != RenderTargetHeight)
-				{
+	const bool bSettled = FMath::IsNearlyEqual(CurrentScale, LastTransformScale);
+	LastTransformScale = CurrentScale;
 
-					// If the render target resource already exists just resize it.  Calling InitCustomFormat flushes render commands which could result in a huge hitch
-					if (RenderTarget->GameThread_GetRenderTargetResource() && RenderTarget->OverrideFormat == PF_B8G8R8A8)
-					{
-						RenderTarget->ResizeTarget(RenderTargetWidth, RenderTargetHeight);
-					}
-					else
-					{
-						const bool bForceLinearGamma = false;
-						RenderTarget->InitCustomFormat(RenderTargetWidth, RenderTargetHeight, PF_B8G8R8A8, bForceLinearGamma);
-						RenderTarget->UpdateResourceImmediate();
-					}
-				}
+	// Scaling down from the peak keeps the quality, so while the scale animates only growing past the band redraws.
+	// Once it settles, a surface drawn below the largest scale seen is drawn again at it, rather than left upscaled.
+	if (PeakTransformScale <= 0.f || CurrentScale > PeakTransformScale * (1.f + TransformQualityBand) || (bSettled && PeakTransformScale < MaxTransformScale))
+	{
+		PeakTransformScale = MaxTransformScale;
+	}
 
-				const float Scale = AllottedGeometry.Scale;
+	return PeakTransformScale;
+}
 
-				const FVector2D DrawSize = FVector2D(RenderTargetWidth, RenderTargetHeight);
-				const FGeometry WindowGeometry = FGeometry::MakeRoot(DrawSize * (1 / Scale), FSlateLayoutTransform(Scale, PaintGeometry.DrawPosition));
+void SUIRetainerBoxWidget::SetGroup(const TSharedPtr<FUIRetainerGroupState>& InGroup)
+{
+	if (Group == InGroup)
+	{
+		return;
+	}
 
-				// Update the surface brush to match the latest size.
-				SurfaceBrush.ImageSize = DrawSize;
+	if (Group.IsValid())
+	{
+		Group->RemoveMember(this);
+	}
 
-				WidgetRenderer->ViewOffset = -ViewOffset;
+	Group = InGroup;
 
-				SUIRetainerBoxWidget* MutableThis = const_cast<SUIRetainerBoxWidget*>(this);
-				TSharedRef<SUIRetainerBoxWidget> SharedMutableThis = SharedThis(MutableThis);
+	if (Group.IsValid())
+	{
+		GroupSlot = Group->AddMember(SharedThis(this));
+	}
+}
 
-				FPaintArgs PaintArgs(*this, Args.GetGrid(), Args.GetWindowToDesktopTransform(), FApp::GetCurrentTime(), Args.GetDeltaTime());
+void SUIRetainerBoxWidget::SetDeferredContent(TFunction<TSharedRef<SWidget>()> InContentBuilder)
+{
+	DeferredContentBuilder = MoveTemp(InContentBuilder);
+}
 
-				RootCacheNode = CreateCacheNode();
-				RootCacheNode->Initialize(Args, SharedMutableThis, WindowGeometry);
+bool SUIRetainerBoxWidget::ShouldShowBakedSurface() const
+{
+	return RenderingResources->BakedSurface && (bBakedSurfaceFrozen || RedrawCount == 0);
+}
 
-				WidgetRenderer->DrawWindow(
-					PaintArgs.EnableCaching(SharedMutableThis, RootCacheNode, true, true),
-					RenderTarget,
-					Window.ToSharedRef(),
-					WindowGeometry,
-					WindowGeometry.GetLayoutBoundingRect(),
-					TimeSinceLastDraw,
-					GDeferUIRetainedRenderingRenderThread != 0);
+void SUIRetainerBoxWidget::BuildDeferredContent()
+{
+	// Give the baked surface a frame on screen to itself, unless there's nothing to show in the meantime.
+	// While it's loading, whether the content is needed at all isn't known yet.
+	if (!DeferredContentBuilder || bBakedSurfaceLoading || (ShouldShowBakedSurface() && bEnableUIRetainedRendering && GFrameCounter <= BakedSurfaceShownFrame))
+	{
+		return;
+	}
 
-				bRenderRequested = false;
-				Shared_WaitingToRender.Remove(this);
+	SetContent(DeferredContentBuilder());
+	DeferredContentBuilder = nullptr;
+	RequestRender();
+}
 
-				LastDrawTime = FApp::GetCurrentTime();
+void SUIRetainerBoxWidget::SetReplayElementsOnOutputChange(bool bInReplayElements)
+{
+	bReplayElementsOnOutputChange = bInReplayElements;
 
-				return true;
-			}
-		}
+	if (bReplayElementsOnOutputChange)
+	{
+		CreateReplayWindow();
 	}
+	else
+	{
+		// The renderer keeps the cached buffers alive until told otherwise.
+		if (RecordedRenderData.IsValid() && FSlateApplication::IsInitialized())
+		{
+			FSlateApplication::Get().GetRenderer()->ReleaseCachingResourcesFor(this);
+		}
 
-	return false;
+		RecordedElements.Reset();
+		RecordedRenderData.Reset();
+		bContentDirty = true;
+	}
 }
 
-int32 SUIRetainerBoxWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+void SUIRetainerBoxWidget::CreateReplayWindow()
 {
-	STAT(FScopeCycleCounter PaintCycleCounter(MyStatId);)
+	if (!ReplayWindow.IsValid())
+	{
+		ReplayWidget = SNew(SUIRetainerBoxElementReplay);
 
-		SUIRetainerBoxWidget* MutableThis = const_cast<SUIRetainerBoxWidget*>(this);
+		ReplayWindow = SNew(SVirtualWindow)
+			.Visibility(EVisibility::HitTestInvisible);
 
-	MutableThis->RefreshRenderingMode();
+		ReplayWindow->SetShouldResolveDeferred(false);
+		ReplayWindow->SetContent(ReplayWidget.ToSharedRef());
+	}
+}
+
+void SUIRetainerBoxWidget::SetTiledRedraw(bool bInTiledRedraw, int32 InTileSize, int32 InMaxTilesPerFrame)
+{
+	const int32 NewTileSize = FMath::Max(InTileSize, 64);
 
-	if (bEnableUIRetainedRendering && IsAnythingVisibleToRender())
+	if (bTiledRedraw != bInTiledRedraw || TileSize != NewTileSize)
 	{
-		SCOPE_CYCLE_COUNTER(STAT_SlateRetainerWidgetPaint);
+		ReleaseTiles();
+		RequestRender();
+	}
 
-		TSharedRef<SUIRetainerBoxWidget> SharedMutableThis = SharedThis(MutableThis);
+	bTiledRedraw = bInTiledRedraw;
+	TileSize = NewTileSize;
+	MaxTilesPerFrame = FMath::Max(InMaxTilesPerFrame, 1);
+}
 
-		const bool bNewFramePainted = MutableThis->PaintRetainedContent(Args, AllottedGeometry);
+bool SUIRetainerBoxWidget::ShouldDrawTiled(const FVector2D& RenderSize) const
+{
+	// Effect materials sample a single texture, and shared surfaces and readbacks expect one too.
+	return bTiledRedraw && !bDynamicMaterialInUse && SurfaceKey == NAME_None && PendingReadbacks.Num() == 0 && !GUsingNullRHI &&
+		(RenderSize.X > TileSize || RenderSize.Y > TileSize);
+}
 
-		UTextureRenderTarget2D* RenderTarget = RenderingResources->RenderTarget;
+void SUIRetainerBoxWidget::LayoutTiles(FIntPoint SurfaceSize)
+{
+	ReleaseTiles();
 
-		if (RenderTarget->GetSurfaceWidth() >= 1 && RenderTarget->GetSurfaceHeight() >= 1)
-		{
-			const FLinearColor ComputedColorAndOpacity(InWidgetStyle.GetColorAndOpacityTint() * ColorAndOpacity.Get() * SurfaceBrush.GetTint(InWidgetStyle));
-			const FLinearColor AdjustedColor(ComputedColorAndOpacity / ComputedColorAndOpacity.A);
-			const FLinearColor PremultipliedColorAndOpacity(ComputedColorAndOpacity * ComputedColorAndOpacity.A);
+	TiledSurfaceSize = SurfaceSize;
 
-			FWidgetRenderer* WidgetRenderer = RenderingResources->WidgetRenderer;
-			UMaterialInstanceDynamic* DynamicEffect = RenderingResources->DynamicEffect;
+	// The tiles replace the full size target, which would otherwise sit in memory next to both sets of them.
+	// The untiled path creates it again if the surface stops being tiled.
+	UTextureRenderTarget2D* RenderTarget = RenderingResources->RenderTarget;
+	if (RenderTarget && RenderTarget->GameThread_GetRenderTargetResource())
+	{
+		RenderTarget->ReleaseResource();
+	}
 
-			if (bDynamicMaterialInUse)
-			{
-				DynamicEffect->SetTextureParameterValue(DynamicEffectTextureParameter, RenderTarget);
-			}
+	const bool bWriteContentInGammaSpace = ShouldWriteContentInGammaSpace();
 
-			FSlateDrawElement::MakeBox(
-				OutDrawElements,
-				LayerId,
-				AllottedGeometry.ToPaintGeometry(),
-				&SurfaceBrush,
-				ColourSpace == EUIRetainerBoxColourSpace::Linear && bDynamicMaterialInUse
-					? ESlateDrawEffect::None
-					: ESlateDrawEffect::PreMultipliedAlpha | ESlateDrawEffect::NoGamma,
-				ColourSpace == EUIRetainerBoxColourSpace::Linear && bDynamicMaterialInUse
-					? FLinearColor(AdjustedColor.R, AdjustedColor.G, AdjustedColor.B, ComputedColorAndOpacity.A)
-					: PremultipliedColorAndOpacity
-			);
+	for (int32 Y = 0; Y < SurfaceSize.Y; Y += TileSize)
+	{
+		for (int32 X = 0; X < SurfaceSize.X; X += TileSize)
+		{
+			FRetainedTile& Tile = Tiles.AddDefaulted_GetRef();
+			Tile.Rect = FIntRect(X, Y, FMath::Min(X + TileSize, SurfaceSize.X), FMath::Min(Y + TileSize, SurfaceSize.Y));
+			Tile.FrontTarget = RenderingResources->TileTargets.Num();
+			Tile.BackTarget = Tile.FrontTarget + 1;
+			Tile.FrontBrush.ImageSize = FVector2D(Tile.Rect.Size());
 
-			if (RootCacheNode)
+			for (int32 Index = 0; Index < 2; Index++)
 			{
-				RootCacheNode->RecordHittestGeometry(Args.GetGrid(), Args.GetLastHitTestIndex(), LayerId, FVector2D(0, 0));
+				UTextureRenderTarget2D* TileTarget = NewObject<UTextureRenderTarget2D>();
+				TileTarget->ClearColor = FLinearColor::Transparent;
+				TileTarget->OverrideFormat = PF_B8G8R8A8;
+				TileTarget->bForceLinearGamma = false;
+				TileTarget->TargetGamma = !bWriteContentInGammaSpace ? 0.f : 1.f;
+				TileTarget->SRGB = !bWriteContentInGammaSpace;
+				TileTarget->SizeX = Tile.Rect.Width();
+				TileTarget->SizeY = Tile.Rect.Height();
+
+				// Created on the rendering thread ahead of the draws into it, so there's no need to flush.
+				TileTarget->UpdateResource();
+
+				RenderingResources->TileTargets.Add(TileTarget);
 			}
+		}
+	}
+}
 
-			// Any deferred painted elements of the retainer should be drawn directly by the main renderer, not rendered into the render target,
-			// as most of those sorts of things will break the rendering rect, things like tooltips, and popup menus.
-			for (auto& DeferredPaint : WidgetRenderer->DeferredPaints)
-			{
-				OutDrawElements.QueueDeferredPainting(DeferredPaint->Copy(Args));
-			}
+void SUIRetainerBoxWidget::ReleaseTiles()
+{
+	Tiles.Reset();
+	RenderingResources->TileTargets.Reset();
+	TiledSurfaceSize = FIntPoint::ZeroValue;
+	bTiledFrontValid = false;
+	NextTileToDraw = INDEX_NONE;
+	TiledRedrawRestarts = 0;
+
+	// Versions are replayed from the recorded render data, which is only kept past them for the output change replay.
+	if (!bReplayElementsOnOutputChange)
+	{
+		if (RecordedRenderData.IsValid() && FSlateApplication::IsInitialized())
+		{
+			FSlateApplication::Get().GetRenderer()->ReleaseCachingResourcesFor(this);
 		}
 
-		return LayerId;
+		RecordedElements.Reset();
+		RecordedRenderData.Reset();
+		bContentDirty = true;
 	}
-
-	return SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
 }
 
-FVector2D SUIRetainerBoxWidget::ComputeDesiredSize(float LayoutScaleMuliplier) const
+void SUIRetainerBoxWidget::EvictSurface()
 {
-	if (bEnableUIRetainedRendering)
+	// A restore in flight is left to finish, the surface can be evicted again after.
+	if (EvictionState == EEvictionState::Pending || EvictionState == EEvictionState::Evicted || EvictionState == EEvictionState::Restoring)
+	{
+		return;
+	}
+
+	// The compressed pixels are still around after a restore, so only the restored texture needs letting go.
+	if (EvictionState == EEvictionState::Restored)
+	{
+		RenderingResources->RestoredSurface = nullptr;
+		RestoredSurfaceBrush.SetResourceObject(nullptr);
+		EvictionState = EEvictionState::Evicted;
+		return;
+	}
+
+	// Shared surfaces aren't ours to release, and tiles can't be read back as one surface.
+	if (RedrawCount == 0 || SharedSurface.IsValid() || Tiles.Num() > 0 || GUsingNullRHI)
+	{
+		return;
+	}
+
+	EvictionState = EEvictionState::Pending;
+
+	FUIRetainerBoxReadback::ReadPixels(GetRenderTarget(), GFrameCounter,
+		FOnUIRetainerBoxReadbackComplete::CreateSP(this, &SUIRetainerBoxWidget::OnEvictedSurfaceReadback, EvictionSerial));
+}
+
+void SUIRetainerBoxWidget::OnEvictedSurfaceReadback(FUIRetainerBoxReadbackResult& Result, int32 Serial)
+{
+	if (Serial != EvictionSerial || EvictionState != EEvictionState::Pending)
+	{
+		return;
+	}
+
+	if (Result.Pixels.Num() == 0)
+	{
+		EvictionState = EEvictionState::None;
+		return;
+	}
+
+	FUIRetainerBoxEvictionJobRef Job = MakeShared<FUIRetainerBoxEvictionJob, ESPMode::ThreadSafe>();
+	Job->Serial = Serial;
+	Job->Size = Result.Size;
+	Job->Pixels = MoveTemp(Result.Pixels);
+	Job->CompressedData = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+
+	Async<void>(EAsyncExecution::ThreadPool, [Job]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const int32 UncompressedSize = Job->Pixels.Num() * Job->Pixels.GetTypeSize();
+
+		int32 CompressedSize = FCompression::CompressMemoryBound(COMPRESS_ZLIB, UncompressedSize);
+		Job->CompressedData->SetNumUninitialized(CompressedSize);
+
+		const bool bCompressed = FCompression::CompressMemory(COMPRESS_ZLIB, Job->CompressedData->GetData(), CompressedSize, Job->Pixels.GetData(), UncompressedSize);
+		Job->CompressedData->SetNum(bCompressed ? CompressedSize : 0);
+		Job->Pixels.Empty();
+
+		Job->WorkMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		Job->bDone = true;
+	});
+
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&SUIRetainerBoxWidget::TickEviction, TWeakPtr<SUIRetainerBoxWidget>(SharedThis(this)), Job));
+}
+
+bool SUIRetainerBoxWidget::TickEviction(float DeltaTime, TWeakPtr<SUIRetainerBoxWidget> WeakRetainer, FUIRetainerBoxEvictionJobRef Job)
+{
+	if (!Job->bDone)
+	{
+		return true;
+	}
+
+	if (TSharedPtr<SUIRetainerBoxWidget> Retainer = WeakRetainer.Pin())
+	{
+		if (Job->bRestore)
+		{
+			Retainer->FinishRestore(*Job);
+		}
+		else
+		{
+			Retainer->FinishEviction(*Job);
+		}
+	}
+
+	return false;
+}
+
+void SUIRetainerBoxWidget::FinishEviction(FUIRetainerBoxEvictionJob& Job)
+{
+	if (Job.Serial != EvictionSerial || EvictionState != EEvictionState::Pending)
+	{
+		return;
+	}
+
+	if (Job.CompressedData->Num() == 0)
+	{
+		EvictionState = EEvictionState::None;
+		return;
+	}
+
+	EvictedSurfaceData = Job.CompressedData;
+	EvictedSurfaceSize = Job.Size;
+
+	EvictionStats.UncompressedBytes = Job.Size.X * Job.Size.Y * sizeof(FColor);
+	EvictionStats.CompressedBytes = EvictedSurfaceData->Num();
+	EvictionStats.CompressMs = Job.WorkMs;
+
+	// The pixels are safe in system memory, so the render target can go.  It's created again on the next redraw.
+	GetRenderTarget()->ReleaseResource();
+
+	EvictionState = EEvictionState::Evicted;
+}
+
+void SUIRetainerBoxWidget::RestoreEvictedSurface()
+{
+	EvictionState = EEvictionState::Restoring;
+
+	// The compressed pixels are shared with the worker rather than copied, and stay with the retainer so it can be
+	// evicted again without another readback.
+	FUIRetainerBoxEvictionJobRef Job = MakeShared<FUIRetainerBoxEvictionJob, ESPMode::ThreadSafe>();
+	Job->Serial = EvictionSerial;
+	Job->bRestore = true;
+	Job->Size = EvictedSurfaceSize;
+	Job->CompressedData = EvictedSurfaceData;
+	Job->StartTime = FPlatformTime::Seconds();
+
+	Async<void>(EAsyncExecution::ThreadPool, [Job]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		Job->Pixels.SetNumUninitialized(Job->Size.X * Job->Size.Y);
+
+		const bool bUncompressed = FCompression::UncompressMemory(COMPRESS_ZLIB, Job->Pixels.GetData(), Job->Pixels.Num() * Job->Pixels.GetTypeSize(), Job->CompressedData->GetData(), Job->CompressedData->Num());
+		if (!bUncompressed)
+		{
+			Job->Pixels.Empty();
+		}
+		Job->CompressedData.Reset();
+
+		Job->WorkMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		Job->bDone = true;
+	});
+
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&SUIRetainerBoxWidget::TickEviction, TWeakPtr<SUIRetainerBoxWidget>(SharedThis(this)), Job));
+}
+
+void SUIRetainerBoxWidget::FinishRestore(FUIRetainerBoxEvictionJob& Job)
+{
+	if (Job.Serial != EvictionSerial || EvictionState != EEvictionState::Restoring)
+	{
+		return;
+	}
+
+	UTexture2D* RestoredSurface = Job.Pixels.Num() > 0 ? UTexture2D::CreateTransient(Job.Size.X, Job.Size.Y, PF_B8G8R8A8) : nullptr;
+
+	// Without the pixels all that's left is drawing the content again.
+	if (!RestoredSurface)
+	{
+		DiscardEvictedSurface();
+		RequestRender();
+		return;
+	}
+
+	RestoredSurface->SRGB = GetRenderTarget()->SRGB;
+
+	FByteBulkData& MipData = RestoredSurface->PlatformData->Mips[0].BulkData;
+	FMemory::Memcpy(MipData.Lock(LOCK_READ_WRITE), Job.Pixels.GetData(), Job.Pixels.Num() * Job.Pixels.GetTypeSize());
+	MipData.Unlock();
+
+	RestoredSurface->UpdateResource();
+
+	RenderingResources->RestoredSurface = RestoredSurface;
+	RestoredSurfaceBrush.SetResourceObject(RestoredSurface);
+	RestoredSurfaceBrush.ImageSize = FVector2D(Job.Size);
+
+	// Timed from when the restore started, so the frames spent waiting on the worker and the ticker count too.
+	EvictionStats.RestoreMs = (FPlatformTime::Seconds() - Job.StartTime) * 1000.0;
+	EvictionStats.RestoreCount++;
+
+	EvictionState = EEvictionState::Restored;
+
+	// Nothing else may be invalidating the retainer, make sure the surface gets painted.
+	Invalidate(EInvalidateWidget::Paint);
+}
+
+void SUIRetainerBoxWidget::DiscardEvictedSurface()
+{
+	EvictionState = EEvictionState::None;
+	EvictionSerial++;
+
+	EvictedSurfaceData.Reset();
+	EvictedSurfaceSize = FIntPoint::ZeroValue;
+
+	RenderingResources->RestoredSurface = nullptr;
+	RestoredSurfaceBrush.SetResourceObject(nullptr);
+}
+
+void SUIRetainerBoxWidget::SetSurfaceKey(FName InSurfaceKey, int32 InContentVersion)
+{
+	if (SurfaceKey != InSurfaceKey || SurfaceContentVersion != InContentVersion)
+	{
+		SurfaceKey = InSurfaceKey;
+		SurfaceContentVersion = InContentVersion;
+
+		ReleaseSharedSurface();
+		RequestRender();
+	}
+}
+
+void SUIRetainerBoxWidget::AcquireSharedSurface(uint32 Width, uint32 Height)
+{
+	const FUIRetainerBoxSurfaceKey Key(SurfaceKey, FIntPoint(Width, Height), SurfaceContentVersion, ShouldWriteContentInGammaSpace());
+
+	if (SharedSurface.IsValid() && SharedSurface->Key == Key)
+	{
+		return;
+	}
+
+	SharedSurface = FUIRetainerBoxSharedSurface::FindOrCreate(Key);
+
+	if (!bDynamicMaterialInUse)
+	{
+		SurfaceBrush.SetResourceObject(SharedSurface->RenderTarget);
+	}
+}
+
+void SUIRetainerBoxWidget::ReleaseSharedSurface()
+{
+	if (SharedSurface.IsValid())
+	{
+		SharedSurface.Reset();
+
+		if (!bDynamicMaterialInUse)
+		{
+			SurfaceBrush.SetResourceObject(RenderingResources->RenderTarget);
+		}
+	}
+}
+
+void SUIRetainerBoxWidget::SetAsyncSurfaceCreation(bool bInAsyncSurfaceCreation)
+{
+	bAsyncSurfaceCreation = bInAsyncSurfaceCreation;
+}
+
+void SUIRetainerBoxWidget::PrewarmSurface(FIntPoint Size)
+{
+	if (Size.X <= 0 || Size.Y <= 0)
+	{
+		return;
+	}
+
+	if (SurfaceKey != NAME_None)
+	{
+		AcquireSharedSurface(Size.X, Size.Y);
+		return;
+	}
+
+	UTextureRenderTarget2D* RenderTarget = RenderingResources->RenderTarget;
+
+	if (RenderTarget->GetSurfaceWidth() != Size.X || RenderTarget->GetSurfaceHeight() != Size.Y)
+	{
+		BeginCreateRetainerSurface(RenderTarget, Size.X, Size.Y, SurfaceCreationFence);
+	}
+}
+
+void SUIRetainerBoxWidget::SetScreenSizeLOD(bool bInEnableScreenSizeLOD, const TArray<FUIRetainerBoxLODTier>& InLODTiers)
+{
+	bEnableScreenSizeLOD = bInEnableScreenSizeLOD;
+
+	LODTiers = InLODTiers;
+	LODTiers.Sort([](const FUIRetainerBoxLODTier& A, const FUIRetainerBoxLODTier& B)
+	{
+		return A.MaxScreenSize < B.MaxScreenSize;
+	});
+
+	CurrentLODTier = INDEX_NONE;
+
+	// A different tier only changes the target size, which repaints the content anyway.
+	RequestReplay();
+}
+
+const FUIRetainerBoxLODTier* SUIRetainerBoxWidget::ChooseLODTier(const FVector2D& InRenderSize)
+{
+	// The visible fraction is of the area, so its square root scales the length of the longest axis.
+	const float EffectiveScreenSize = InRenderSize.GetMax() * FMath::Sqrt(VisibleFraction);
+
+	// Keep the current tier until the size is clear of its bounds, otherwise a retainer sitting on a threshold
+	// would switch tiers and reallocate its target every other frame.
+	static const float LODTierHysteresis = 0.1f;
+
+	if (LODTiers.IsValidIndex(CurrentLODTier) || CurrentLODTier == LODTiers.Num())
+	{
+		const float LowerBound = CurrentLODTier > 0 ? LODTiers[CurrentLODTier - 1].MaxScreenSize : 0.f;
+		const float UpperBound = CurrentLODTier < LODTiers.Num() ? LODTiers[CurrentLODTier].MaxScreenSize : MAX_flt;
+
+		if (EffectiveScreenSize >= LowerBound * (1.f - LODTierHysteresis) && EffectiveScreenSize <= UpperBound * (1.f + LODTierHysteresis))
+		{
+			return LODTiers.IsValidIndex(CurrentLODTier) ? &LODTiers[CurrentLODTier] : nullptr;
+		}
+	}
+
+	CurrentLODTier = LODTiers.Num();
+
+	for (int32 TierIndex = 0; TierIndex < LODTiers.Num(); TierIndex++)
+	{
+		if (EffectiveScreenSize <= LODTiers[TierIndex].MaxScreenSize)
+		{
+			CurrentLODTier = TierIndex;
+			break;
+		}
+	}
+
+	return LODTiers.IsValidIndex(CurrentLODTier) ? &LODTiers[CurrentLODTier] : nullptr;
+}
+
+FChildren* SUIRetainerBoxWidget::GetChildren()
+{
+	if (bEnableUIRetainedRendering)
+	{
+		return &EmptyChildSlot;
+	}
+	else
+	{
+		return SCompoundWidget::GetChildren();
+	}
+}
+
+bool SUIRetainerBoxWidget::ComputeVolatility() const
+{
+	return true;
+}
+
+FCachedWidgetNode* SUIRetainerBoxWidget::CreateCacheNode() const
+{
+	TArray< FCachedWidgetNode* >& Pool = NodePool;
+	int32& PoolIndex = LastUsedCachedNodeIndex;
+
+	// If the node pool is empty, allocate a few
+	if (PoolIndex >= Pool.Num())
+	{
+		for (int32 i = 0; i < 10; i++)
+		{
+			Pool.Add(new FCachedWidgetNode());
+		}
+	}
+
+	// Return one of the preallocated nodes and increment the next node index.
+	FCachedWidgetNode* NewNode = Pool[PoolIndex];
+	++PoolIndex;
+
+	return NewNode;
+}
+
+SUIRetainerBoxWidget::EInvalidationClass SUIRetainerBoxWidget::ClassifyInvalidation(const SWidget* InvalidateWidget) const
+{
+	if (!InvalidateWidget || GFilterUIRetainerInvalidations == 0)
+	{
+		return EInvalidationClass::Accepted;
+	}
+
+	static const FName WidgetSwitcherType(TEXT("SWidgetSwitcher"));
+
+	// Nothing under a hidden widget or an inactive switcher slot gets painted.  The widget's own visibility
+	// is left out, as changing it is one of the things that invalidates it.
+	const SWidget* Child = InvalidateWidget;
+	TSharedPtr<SWidget> Parent = InvalidateWidget->GetParentWidget();
+
+	while (Parent.IsValid() && Parent.Get() != Window.Get())
+	{
+		if (!Parent->GetVisibility().IsVisible())
+		{
+			return EInvalidationClass::Hidden;
+		}
+
+		if (Parent->GetType() == WidgetSwitcherType && StaticCastSharedPtr<SWidgetSwitcher>(Parent)->GetActiveWidget().Get() != Child)
+		{
+			return EInvalidationClass::Hidden;
+		}
+
+		Child = Parent.Get();
+		Parent = Parent->GetParentWidget();
+	}
+
+	// Content outside of the retainer's bounds isn't filtered.  Invalidations don't say whether layout changed,
+	// which could bring the widget or its siblings into view, and that can't be known without measuring again.
+	return EInvalidationClass::Accepted;
+}
+
+void SUIRetainerBoxWidget::InvalidateWidget(SWidget* InvalidateWidget)
+{
+	switch (ClassifyInvalidation(InvalidateWidget))
+	{
+	case EInvalidationClass::Hidden:
+		InvalidationStats.FilteredHidden++;
+		return;
+	default:
+		InvalidationStats.Accepted++;
+		break;
+	}
+
+	bContentDirty = true;
+
+	if (RenderOnInvalidation)
+	{
+		RequestRender();
+	}
+}
+
+void SUIRetainerBoxWidget::RequestReadback(const FOnUIRetainerBoxReadbackComplete& OnComplete)
+{
+	PendingReadbacks.Add(OnComplete);
+	RequestRender();
+}
+
+void SUIRetainerBoxWidget::ServicePendingReadbacks(UTextureRenderTarget2D* RenderTarget)
+{
+	for (const FOnUIRetainerBoxReadbackComplete& OnReadbackComplete : PendingReadbacks)
+	{
+		FUIRetainerBoxReadback::ReadPixels(RenderTarget, GFrameCounter, OnReadbackComplete);
+	}
+
+	PendingReadbacks.Reset();
+}
+
+void SUIRetainerBoxWidget::PaintWindowElements(const FPaintArgs& PaintArgs, const FGeometry& WindowGeometry, FSlateWindowElementList& OutElementList)
+{
+	Window->Paint(
+		PaintArgs,
+		WindowGeometry,
+		WindowGeometry.GetLayoutBoundingRect(),
+		OutElementList,
+		0,
+		FWidgetStyle(),
+		Window->IsEnabled());
+
+	RenderingResources->WidgetRenderer->DeferredPaints = OutElementList.GetDeferredPaintList();
+}
+
+void SUIRetainerBoxWidget::RecordHitTestGeometry(const FPaintArgs& Args, const FVector2D& LocalSize, float HitTestScale, const FVector2D& DrawPosition)
+{
+	TSharedRef<SUIRetainerBoxWidget> SharedMutableThis = SharedThis(this);
+
+	const FGeometry HitTestGeometry = FGeometry::MakeRoot(LocalSize, FSlateLayoutTransform(HitTestScale, DrawPosition));
+
+	// Reset the cached node pool index so that we effectively reset the pool.
+	LastUsedCachedNodeIndex = 0;
+	RootCacheNode = CreateCacheNode();
+	RootCacheNode->Initialize(Args, SharedMutableThis, HitTestGeometry);
+
+	FPaintArgs PaintArgs(*this, Args.GetGrid(), Args.GetWindowToDesktopTransform(), FApp::GetCurrentTime(), Args.GetDeltaTime());
+
+	FSlateWindowElementList HitTestElementList(Window);
+	PaintWindowElements(PaintArgs.EnableCaching(SharedMutableThis, RootCacheNode, true, true), HitTestGeometry, HitTestElementList);
+
+	LastHitTestScale = HitTestScale;
+	FrontDeferredPaints = RenderingResources->WidgetRenderer->DeferredPaints;
+}
+
+void SUIRetainerBoxWidget::SetRenderingPhase(int32 InPhase, int32 InPhaseCount)
+{
+	Phase = InPhase;
+	PhaseCount = InPhaseCount;
+}
+
+void SUIRetainerBoxWidget::RequestRender()
+{
+	ScheduleState.bRenderRequested = true;
+	bRequestedSinceLastPaint = true;
+	bContentDirty = true;
+
+	if (NextTileToDraw != INDEX_NONE)
+	{
+		bRequestedDuringTiledRedraw = true;
+	}
+}
+
+void SUIRetainerBoxWidget::RequestReplay()
+{
+	ScheduleState.bRenderRequested = true;
+	bRequestedSinceLastPaint = true;
+}
+
+void SUIRetainerBoxWidget::RecordElements(const FPaintArgs& PaintArgs, const FGeometry& WindowGeometry, const FVector2D& DrawPosition, FIntPoint DrawSize)
+{
+	RecordedElements = MakeShareable(new FSlateWindowElementList(Window));
+	PaintWindowElements(PaintArgs, WindowGeometry, *RecordedElements);
+
+	RecordedRenderData = RecordedElements->CacheRenderData(this);
+	RecordedDrawPosition = DrawPosition;
+	RecordedSize = DrawSize;
+	RecordedScale = WindowGeometry.Scale;
+
+	bContentDirty = false;
+}
+
+void SUIRetainerBoxWidget::DrawRecordedElements(const FPaintArgs& PaintArgs, UTextureRenderTarget2D* RenderTarget, const FGeometry& WindowGeometry, const FVector2D& DrawPosition, double DeltaTime)
+{
+	FWidgetRenderer* WidgetRenderer = RenderingResources->WidgetRenderer;
+
+	// The recorded elements were painted at the draw position of the time, move them to where we are now.
+	ReplayWidget->SetRenderData(RecordedRenderData, (DrawPosition - RecordedDrawPosition).RoundToVector());
+
+	// Drawing the replay window replaces the deferred paints, which still belong to the recorded content.
+	const auto RecordedDeferredPaints = WidgetRenderer->DeferredPaints;
+
+	WidgetRenderer->DrawWindow(
+		PaintArgs,
+		RenderTarget,
+		ReplayWindow.ToSharedRef(),
+		WindowGeometry,
+		WindowGeometry.GetLayoutBoundingRect(),
+		DeltaTime,
+		GDeferUIRetainedRenderingRenderThread != 0);
+
+	WidgetRenderer->DeferredPaints = RecordedDeferredPaints;
+}
+
+bool SUIRetainerBoxWidget::PaintRetainedContent(const FPaintArgs& Args, const FGeometry& AllottedGeometry)
+{
+	const FPaintGeometry PaintGeometry = AllottedGeometry.ToPaintGeometry();
+	FVector2D FullRenderSize = PaintGeometry.GetLocalSize() * PaintGeometry.GetAccumulatedRenderTransform().GetMatrix().GetScale().GetVector();
+
+	float TransformScale = 1.f;
+
+	// The scale the content is shown at, which is what its hit test geometry has to match.
+	float ShownScale = AllottedGeometry.Scale;
+
+	if (bTransformTolerant && AllottedGeometry.Scale > 0.f)
+	{
+		// Draw at a steady scale and let the render transform scale the surface when it's composited.
+		const float CurrentScale = FullRenderSize.GetMax() / FMath::Max(PaintGeometry.GetLocalSize().GetMax() * AllottedGeometry.Scale, KINDA_SMALL_NUMBER);
+
+		TransformScale = ChooseTransformScale(CurrentScale);
+		FullRenderSize = PaintGeometry.GetLocalSize() * AllottedGeometry.Scale * TransformScale;
+		ShownScale = AllottedGeometry.Scale * CurrentScale;
+	}
+
+	int32 RefreshIntervalMultiplier = 1;
+	float ResolutionScale = 1.f;
+
+	if (bEnableScreenSizeLOD)
+	{
+		if (const FUIRetainerBoxLODTier* LODTier = ChooseLODTier(FullRenderSize))
+		{
+			RefreshIntervalMultiplier = FMath::Max(LODTier->RefreshIntervalMultiplier, 1);
+			ResolutionScale = FMath::Clamp(LODTier->ResolutionScale, 0.1f, 1.f);
+		}
+	}
+
+	const FVector2D RenderSize = FullRenderSize * ResolutionScale;
+
+	FUIRetainerScheduleInput ScheduleInput;
+	ScheduleInput.Frame = GFrameCounter;
+	// Refreshing on our phase would throw away an evicted surface for a redraw, only a real request should.
+	ScheduleInput.bRenderOnPhase = RenderOnPhase && (EvictionState == EEvictionState::None || EvictionState == EEvictionState::Pending);
+	ScheduleInput.Phase = Phase;
+	ScheduleInput.PhaseCount = PhaseCount;
+	ScheduleInput.RefreshIntervalMultiplier = RefreshIntervalMultiplier;
+	ScheduleInput.bCulled = bEnableScreenSizeLOD && VisibleFraction <= 0.f;
+	ScheduleInput.bOccluded = bOccluded;
+	ScheduleInput.Width = RenderSize.X;
+	ScheduleInput.Height = RenderSize.Y;
+	ScheduleInput.WorkThisFrame = Shared_RetainerWorkThisFrame.TryGetValue(0);
+
+	if (Group.IsValid())
+	{
+		ScheduleInput.GroupPhaseCount = Group->PhaseCount;
+		ScheduleInput.GroupSlot = GroupSlot;
+		ScheduleInput.bGroupPaused = Group->bPaused;
+		ScheduleInput.GroupMaxWorkPerFrame = Group->MaxWorkPerFrame;
+		ScheduleInput.GroupWorkThisFrame = Group->GetWorkThisFrame();
+	}
+
+	FUIRetainerSchedulingConfig ScheduleConfig;
+	ScheduleConfig.MaxWorkPerFrame = Shared_MaxRetainerWorkPerFrame;
+
+	const FUIRetainerScheduleResult ScheduleResult = FUIRetainerSchedulingPolicy(ScheduleConfig).Evaluate(ScheduleInput, ScheduleState);
+
+	bool bNewFramePainted = false;
+	double PaintCostMs = 0.0;
+	double StartTime = 0.0;
+
+	LastSurfaceCreationMs = 0.0;
+	LastPrepassMs = 0.0;
+	LastPaintMs = 0.0;
+
+	if (ScheduleResult.Decision == EUIRetainerRedrawDecision::Redraw)
+	{
+		// Phased redraws are how content the retainer isn't told about, like animations, gets updated.
+		if (ScheduleResult.Reason == EUIRetainerRedrawReason::Phase)
+		{
+			bContentDirty = true;
+		}
+
+		// Only measured while something captures it, so the channels cost nothing while they're off.
+		if (ShouldMeasureTimings())
+		{
+			StartTime = FPlatformTime::Seconds();
+		}
+
+		if (ShouldDrawTiled(RenderSize))
+		{
+			bNewFramePainted = DrawRetainedContentTiled(Args, AllottedGeometry, PaintGeometry, RenderSize, ResolutionScale * TransformScale, ShownScale);
+		}
+		else
+		{
+			// Drawing the whole surface again, the tiles would only be out of date.
+			if (Tiles.Num() > 0)
+			{
+				ReleaseTiles();
+			}
+
+			// Lower resolution tiers and reference scales only change what's drawn into the target, the content is
+			// still hit tested at the scale it's shown at.
+			bNewFramePainted = DrawRetainedContent(Args, AllottedGeometry, PaintGeometry, RenderSize, ResolutionScale * TransformScale, ShownScale);
+		}
+
+		if (StartTime != 0.0)
+		{
+			PaintCostMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+	}
+	else if (ScheduleResult.Decision == EUIRetainerRedrawDecision::DeferredByBudget)
+	{
+		Shared_WaitingToRender.AddUnique(this);
+	}
+
+	// Transform tolerant surfaces are reused while the render transform animates, so the hit test geometry is
+	// recorded again whenever the shown scale or position moves away from what it was recorded at.
+	// Content that can't be hit tested doesn't need it, which is the usual case for pulsing markers and nameplates.
+	if (!bNewFramePainted && bTransformTolerant && RootCacheNode && IsContentHitTestable())
+	{
+		const FSlateRect InstanceRect(PaintGeometry.DrawPosition, PaintGeometry.DrawPosition + RenderSize);
+
+		if (ShownScale != LastHitTestScale || !(InstanceRect == LastHitTestRect))
+		{
+			RecordHitTestGeometry(Args, AllottedGeometry.GetLocalSize(), ShownScale, PaintGeometry.DrawPosition);
+			LastHitTestRect = InstanceRect;
+		}
+	}
+
+	// Freshly drawn content replaces whatever was evicted, or is about to be.
+	if (bNewFramePainted && EvictionState != EEvictionState::None)
+	{
+		DiscardEvictedSurface();
+	}
+
+	// Whether an occluded retainer stays hidden is only known once the frame is painted, so its event waits for
+	// ResolveOcclusion, which either records it or paints again and records that instead.
+	bOccludedEventPending = ScheduleResult.Decision == EUIRetainerRedrawDecision::Occluded;
+
+	if (bOccludedEventPending)
+	{
+		PendingOccludedInput = ScheduleInput;
+		PendingOccludedRenderSize = RenderSize;
+		bPendingOccludedRequested = bRequestedSinceLastPaint;
+	}
+	else
+	{
+		RecordScheduleEvent(ScheduleInput, bRequestedSinceLastPaint, ScheduleResult, bNewFramePainted, StartTime, PaintCostMs, RenderSize);
+	}
+
+	bRequestedSinceLastPaint = false;
+
+	return bNewFramePainted;
+}
+
+void SUIRetainerBoxWidget::RecordScheduleEvent(const FUIRetainerScheduleInput& Input, bool bRequested, const FUIRetainerScheduleResult& Result, bool bPainted, double StartTime, double PaintCostMs, const FVector2D& RenderSize)
+{
+	if (FUIRetainerTraceRecorder::IsRecording())
+	{
+		FUIRetainerTraceRecorder::Get().RecordEvent(this, Group.Get(), StatName, Input, bRequested, Result, bPainted, bPainted ? PaintCostMs : 0.0);
+	}
+
+	if (FUIRetainerTimeline::IsEnabled())
+	{
+		FUIRetainerTimelineEvent TimelineEvent;
+		TimelineEvent.Retainer = this;
+		TimelineEvent.StatName = StatName;
+		TimelineEvent.Frame = GFrameCounter;
+		TimelineEvent.StartTime = StartTime != 0.0 ? StartTime : FPlatformTime::Seconds();
+		TimelineEvent.Result = Result;
+		TimelineEvent.bPainted = bPainted;
+		TimelineEvent.RenderSize = RenderSize;
+		TimelineEvent.PrepassMs = LastPrepassMs;
+		TimelineEvent.PaintMs = LastPaintMs;
+		TimelineEvent.bDeferredRenderThreadWork = bPainted && GDeferUIRetainedRenderingRenderThread != 0;
+
+		FUIRetainerTimeline::Get().Emit(TimelineEvent);
+	}
+}
+
+bool SUIRetainerBoxWidget::DrawRetainedContent(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FPaintGeometry& PaintGeometry, const FVector2D& RenderSize, float ContentScale, float HitTestScale)
+{
+	const uint32 RenderTargetWidth = FMath::RoundToInt(RenderSize.X);
+	const uint32 RenderTargetHeight = FMath::RoundToInt(RenderSize.Y);
+
+	if (SurfaceKey != NAME_None && RenderTargetWidth != 0 && RenderTargetHeight != 0)
+	{
+		AcquireSharedSurface(RenderTargetWidth, RenderTargetHeight);
+	}
+
+	// If another instance already drew the shared surface this frame there's nothing to draw, we only
+	// need to paint our own widgets again if our hit test geometry is out of date.  Headless readbacks
+	// return our own elements, so with those pending we paint them ourselves.
+	const bool bSharedSurfaceDrawnThisFrame = SharedSurface.IsValid() && SharedSurface->LastDrawnFrame == GFrameCounter &&
+		!(GUsingNullRHI && PendingReadbacks.Num() > 0);
+	const FSlateRect InstanceRect(PaintGeometry.DrawPosition, PaintGeometry.DrawPosition + RenderSize);
+
+	if (bSharedSurfaceDrawnThisFrame && RootCacheNode && InstanceRect == LastHitTestRect && HitTestScale == LastHitTestScale)
+	{
+		ServicePendingReadbacks(SharedSurface->RenderTarget);
+
+		FUIRetainerSchedulingPolicy::OnRedrawn(ScheduleState);
+		Shared_WaitingToRender.Remove(this);
+		return false;
+	}
+
+	// When only the output changed since the content was recorded, draw the recorded elements into the
+	// target again instead of running the prepass and painting the widgets.
+	const bool bReplayRecordedElements = bReplayElementsOnOutputChange && !bContentDirty && RecordedRenderData.IsValid() &&
+		RecordedSize == FIntPoint(RenderTargetWidth, RenderTargetHeight) && RecordedScale == AllottedGeometry.Scale * ContentScale &&
+		!bSharedSurfaceDrawnThisFrame && !GUsingNullRHI;
+
+	const double TimeSinceLastDraw = FApp::GetCurrentTime() - LastDrawTime;
+
+	const FVector2D ViewOffset = PaintGeometry.DrawPosition.RoundToVector();
+
+	// Keep the visibilities the same, the proxy window should maintain the same visible/non-visible hit-testing of the retainer.
+	Window->SetVisibility(GetVisibility());
+
+	// Replaying keeps the hit test geometry from the recording, so there's no need to prepass or reset the cache nodes.
+	if (!bReplayRecordedElements)
+	{
+		// Need to prepass.
+		const double PrepassStartTime = ShouldMeasureTimings() ? FPlatformTime::Seconds() : 0.0;
+		Window->SlatePrepass(AllottedGeometry.Scale);
+		if (PrepassStartTime != 0.0)
+		{
+			LastPrepassMs = (FPlatformTime::Seconds() - PrepassStartTime) * 1000.0;
+		}
+
+		// Reset the cached node pool index so that we effectively reset the pool.
+		LastUsedCachedNodeIndex = 0;
+		RootCacheNode = nullptr;
+	}
+
+	UTextureRenderTarget2D* RenderTarget = GetRenderTarget();
+	FWidgetRenderer* WidgetRenderer = RenderingResources->WidgetRenderer;
+
+	if (RenderTargetWidth != 0 && RenderTargetHeight != 0)
+	{
+		if (MyWidget->GetVisibility().IsVisible())
+		{
+			// Shared surfaces are created at the size they are keyed on, so only our own target ever needs resizing.
+			// Evicted targets keep their size but not their resource.
+			if (!SharedSurface.IsValid() &&
+				(RenderTarget->GetSurfaceWidth() != RenderTargetWidth ||
+				RenderTarget->GetSurfaceHeight() != RenderTargetHeight ||
+				!RenderTarget->GameThread_GetRenderTargetResource()))
+			{
+				const double CreationStartTime = ShouldMeasureTimings() ? FPlatformTime::Seconds() : 0.0;
+
+				if (bAsyncSurfaceCreation)
+				{
+					BeginCreateRetainerSurface(RenderTarget, RenderTargetWidth, RenderTargetHeight, SurfaceCreationFence);
+				}
+				// If the render target resource already exists just resize it.  Calling InitCustomFormat flushes render commands which could result in a huge hitch
+				else if (RenderTarget->GameThread_GetRenderTargetResource() && RenderTarget->OverrideFormat == PF_B8G8R8A8)
+				{
+					RenderTarget->ResizeTarget(RenderTargetWidth, RenderTargetHeight);
+				}
+				// Released targets, evicted or replaced by tiles, keep their format.  Created on the rendering thread ahead
+				// of the draws into it, so there's no need to flush.
+				else if (RenderTarget->OverrideFormat == PF_B8G8R8A8)
+				{
+					RenderTarget->SizeX = RenderTargetWidth;
+					RenderTarget->SizeY = RenderTargetHeight;
+					RenderTarget->UpdateResource();
+				}
+				else
+				{
+					const bool bForceLinearGamma = false;
+					RenderTarget->InitCustomFormat(RenderTargetWidth, RenderTargetHeight, PF_B8G8R8A8, bForceLinearGamma);
+					RenderTarget->UpdateResourceImmediate();
+				}
+
+				if (CreationStartTime != 0.0)
+				{
+					LastSurfaceCreationMs = (FPlatformTime::Seconds() - CreationStartTime) * 1000.0;
+				}
+			}
+
+			// Rather than blocking on the surface being created, keep the request and let OnPaint draw the content directly until it's ready.
+			if (bAsyncSurfaceCreation && IsSurfacePending())
+			{
+				return false;
+			}
+
+			// Shared surfaces drawn by another instance this frame don't count as work, we only paint our hit test geometry.
+			BeginRetainerWork(!bSharedSurfaceDrawnThisFrame);
+
+			// Lower resolution LOD tiers and transform tolerant scales draw the same layout into a differently sized target.
+			const float Scale = AllottedGeometry.Scale * ContentScale;
+
+			const FVector2D DrawSize = FVector2D(RenderTargetWidth, RenderTargetHeight);
+			const FGeometry WindowGeometry = FGeometry::MakeRoot(DrawSize * (1 / Scale), FSlateLayoutTransform(Scale, PaintGeometry.DrawPosition));
+
+			// Geometry cached while drawing at a different scale than the one we're shown at would hit test in the
+			// wrong place, so then the hit test geometry gets its own paint at the shown scale.  Not for content that
+			// can't be hit tested, whatever the draw caches is never used.
+			const bool bSeparateHitTest = !FMath::IsNearlyEqual(Scale, HitTestScale) && IsContentHitTestable();
+
+			// Update the surface brush to match the latest size.
+			SurfaceBrush.ImageSize = DrawSize;
+
+			WidgetRenderer->ViewOffset = -ViewOffset;
+
+			SUIRetainerBoxWidget* MutableThis = const_cast<SUIRetainerBoxWidget*>(this);
+			TSharedRef<SUIRetainerBoxWidget> SharedMutableThis = SharedThis(MutableThis);
+
+			FPaintArgs PaintArgs(*this, Args.GetGrid(), Args.GetWindowToDesktopTransform(), FApp::GetCurrentTime(), Args.GetDeltaTime());
+
+			if (!bReplayRecordedElements && !bSeparateHitTest)
+			{
+				RootCacheNode = CreateCacheNode();
+				RootCacheNode->Initialize(Args, SharedMutableThis, WindowGeometry);
+				LastHitTestRect = InstanceRect;
+				LastHitTestScale = HitTestScale;
+			}
+
+			// Paints that don't record the hit test geometry themselves leave it to RecordHitTestGeometry.
+			const FPaintArgs CachingPaintArgs = RootCacheNode && !bSeparateHitTest ? PaintArgs.EnableCaching(SharedMutableThis, RootCacheNode, true, true) : PaintArgs;
+
+			const double PaintStartTime = ShouldMeasureTimings() ? FPlatformTime::Seconds() : 0.0;
+
+			if (bSharedSurfaceDrawnThisFrame)
+			{
+				// Paint without drawing to rebuild the hit test geometry of our own widgets, the pixels come from the shared surface.
+				if (bSeparateHitTest)
+				{
+					RecordHitTestGeometry(Args, WindowGeometry.GetLocalSize(), HitTestScale, PaintGeometry.DrawPosition);
+					LastHitTestRect = InstanceRect;
+				}
+				else
+				{
+					FSlateWindowElementList HitTestElementList(Window);
+					PaintWindowElements(CachingPaintArgs, WindowGeometry, HitTestElementList);
+				}
+
+				if (PaintStartTime != 0.0)
+				{
+					LastPaintMs = (FPlatformTime::Seconds() - PaintStartTime) * 1000.0;
+				}
+
+				ServicePendingReadbacks(RenderTarget);
+
+				FrontDeferredPaints = WidgetRenderer->DeferredPaints;
+
+				FUIRetainerSchedulingPolicy::OnRedrawn(ScheduleState);
+				Shared_WaitingToRender.Remove(this);
+
+				return false;
+			}
+
+			if (GUsingNullRHI)
+			{
+				// There's nothing to draw to, but still paint the widgets so hit testing works and headless readbacks have elements to return.
+				FSlateWindowElementList HeadlessElementList(Window);
+				PaintWindowElements(CachingPaintArgs, WindowGeometry, HeadlessElementList);
+
+				for (const FOnUIRetainerBoxReadbackComplete& OnReadbackComplete : PendingReadbacks)
+				{
+					FUIRetainerBoxReadback::ReadElements(HeadlessElementList, ViewOffset, FIntPoint(RenderTargetWidth, RenderTargetHeight), OnReadbackComplete);
+				}
+
+				PendingReadbacks.Reset();
+			}
+			else
+			{
+				if (bReplayRecordedElements)
+				{
+					DrawRecordedElements(PaintArgs, RenderTarget, WindowGeometry, PaintGeometry.DrawPosition, TimeSinceLastDraw);
+				}
+				else if (bReplayElementsOnOutputChange)
+				{
+					// Paint into an element list we keep, so later output only changes can draw it again.
+					RecordElements(CachingPaintArgs, WindowGeometry, PaintGeometry.DrawPosition, FIntPoint(RenderTargetWidth, RenderTargetHeight));
+					DrawRecordedElements(PaintArgs, RenderTarget, WindowGeometry, PaintGeometry.DrawPosition, TimeSinceLastDraw);
+				}
+				else
+				{
+					WidgetRenderer->DrawWindow(
+						CachingPaintArgs,
+						RenderTarget,
+						Window.ToSharedRef(),
+						WindowGeometry,
+						WindowGeometry.GetLayoutBoundingRect(),
+						TimeSinceLastDraw,
+						GDeferUIRetainedRenderingRenderThread != 0);
+				}
+
+				ServicePendingReadbacks(RenderTarget);
+			}
+
+			// Replays keep the hit test geometry they were recorded with.
+			if (bSeparateHitTest && !bReplayRecordedElements)
+			{
+				RecordHitTestGeometry(Args, WindowGeometry.GetLocalSize(), HitTestScale, PaintGeometry.DrawPosition);
+				LastHitTestRect = InstanceRect;
+			}
+
+			if (PaintStartTime != 0.0)
+			{
+				LastPaintMs = (FPlatformTime::Seconds() - PaintStartTime) * 1000.0;
+			}
+
+			if (SharedSurface.IsValid())
+			{
+				SharedSurface->LastDrawnFrame = GFrameCounter;
+			}
+
+			FrontDeferredPaints = WidgetRenderer->DeferredPaints;
+
+			FUIRetainerSchedulingPolicy::OnRedrawn(ScheduleState);
+			Shared_WaitingToRender.Remove(this);
+
+			LastDrawTime = FApp::GetCurrentTime();
+			RedrawCount++;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SUIRetainerBoxWidget::BeginRetainerWork(bool bCountWork)
+{
+	// In order to get material parameter collections to function properly, we need the current world's Scene
+	// properly propagated through to any widgets that depend on that functionality. The SceneViewport and RetainerWidget the 
+	// only location where this information exists in Slate, so we push the current scene onto the current
+	// Slate application so that we can leverage it in later calls.
+	UWorld* TickWorld = OuterWorld.Get();
+	if (TickWorld && TickWorld->Scene && IsInGameThread())
+	{
+		FSlateApplication::Get().GetRenderer()->RegisterCurrentScene(TickWorld->Scene);
+	}
+	else if (IsInGameThread())
+	{
+		FSlateApplication::Get().GetRenderer()->RegisterCurrentScene(nullptr);
+	}
+
+	// Update the number of retainers we've drawn this frame.
+	if (bCountWork)
+	{
+		Shared_RetainerWorkThisFrame = Shared_RetainerWorkThisFrame.TryGetValue(0) + 1;
+
+		if (Group.IsValid())
+		{
+			Group->AddWork();
+		}
+	}
+}
+
+bool SUIRetainerBoxWidget::DrawRetainedContentTiled(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FPaintGeometry& PaintGeometry, const FVector2D& RenderSize, float ContentScale, float HitTestScale)
+{
+	const FIntPoint SurfaceSize(FMath::RoundToInt(RenderSize.X), FMath::RoundToInt(RenderSize.Y));
+
+	if (!MyWidget->GetVisibility().IsVisible())
+	{
+		return false;
+	}
+
+	// A new size needs new tiles, which starts the version being drawn over.
+	if (SurfaceSize != TiledSurfaceSize)
+	{
+		LayoutTiles(SurfaceSize);
+	}
+
+	const float Scale = AllottedGeometry.Scale * ContentScale;
+	const FGeometry WindowGeometry = FGeometry::MakeRoot(FVector2D(SurfaceSize) * (1 / Scale), FSlateLayoutTransform(Scale, PaintGeometry.DrawPosition));
+	const FVector2D ViewOffset = PaintGeometry.DrawPosition.RoundToVector();
+
+	if (NextTileToDraw != INDEX_NONE)
+	{
+		// The recorded elements can't be drawn at another scale, and may have been released along with the output change replay.
+		if (!RecordedRenderData.IsValid() || RecordedScale != WindowGeometry.Scale)
+		{
+			NextTileToDraw = INDEX_NONE;
+		}
+		// Content that changed since the version was started starts it over, so it isn't shown a version late.  Content
+		// that keeps changing would never be shown though, so after a few restarts the version is finished as recorded.
+		else if (bRequestedDuringTiledRedraw && TiledRedrawRestarts < MaxTiledRedrawRestarts)
+		{
+			NextTileToDraw = INDEX_NONE;
+			TiledRedrawRestarts++;
+		}
+	}
+
+	// Every slice of a version counts as work, which is what spreads the redraw across frames.
+	BeginRetainerWork(true);
+
+	// The layout is worked out once per version, the tiles drawn on later frames reuse it.
+	const bool bVersionStarted = NextTileToDraw == INDEX_NONE;
+	if (bVersionStarted)
+	{
+		Window->SetVisibility(GetVisibility());
+
+		const double PrepassStartTime = ShouldMeasureTimings() ? FPlatformTime::Seconds() : 0.0;
+		Window->SlatePrepass(AllottedGeometry.Scale);
+		if (PrepassStartTime != 0.0)
+		{
+			LastPrepassMs = (FPlatformTime::Seconds() - PrepassStartTime) * 1000.0;
+		}
+	}
+
+	FPaintArgs PaintArgs(*this, Args.GetGrid(), Args.GetWindowToDesktopTransform(), FApp::GetCurrentTime(), Args.GetDeltaTime());
+
+	const double PaintStartTime = ShouldMeasureTimings() ? FPlatformTime::Seconds() : 0.0;
+
+	// So is the content, every tile is drawn from the same recorded elements so tiles drawn on different frames
+	// still match.  The hit test geometry on screen belongs to the front tiles, so it isn't recorded here.
+	if (bVersionStarted)
+	{
+		CreateReplayWindow();
+		RecordElements(PaintArgs, WindowGeometry, PaintGeometry.DrawPosition, SurfaceSize);
+
+		NextTileToDraw = 0;
+		bRequestedDuringTiledRedraw = false;
+	}
+
+	// Without a complete version to keep on screen, the first one is drawn all at once.
+	const int32 TilesThisFrame = bTiledFrontValid ? MaxTilesPerFrame : Tiles.Num();
+	const int32 LastTileThisFrame = FMath::Min(NextTileToDraw + TilesThisFrame, Tiles.Num());
+
+	for (; NextTileToDraw < LastTileThisFrame; NextTileToDraw++)
+	{
+		const FRetainedTile& Tile = Tiles[NextTileToDraw];
+
+		// The replay draws the recorded batches into each tile's target, which clips them to the tile.
+		RenderingResources->WidgetRenderer->ViewOffset = -(ViewOffset + FVector2D(Tile.Rect.Min));
+		DrawRecordedElements(PaintArgs, RenderingResources->TileTargets[Tile.BackTarget], WindowGeometry, PaintGeometry.DrawPosition, FApp::GetCurrentTime() - LastDrawTime);
+	}
+
+	if (PaintStartTime != 0.0)
+	{
+		LastPaintMs = (FPlatformTime::Seconds() - PaintStartTime) * 1000.0;
+	}
+
+	// Leave the request pending, so the next frame carries on with the remaining tiles.
+	if (NextTileToDraw < Tiles.Num())
+	{
+		return false;
+	}
+
+	// Every tile of the new version is drawn, show it along with its hit test geometry.
+	for (FRetainedTile& Tile : Tiles)
+	{
+		Swap(Tile.FrontTarget, Tile.BackTarget);
+		Tile.FrontBrush.SetResourceObject(RenderingResources->TileTargets[Tile.FrontTarget]);
+	}
+
+	// One unculled pass records the hit test geometry and deferred paints of the whole version.  Without hit testing
+	// the deferred paints of the recording are enough.
+	if (IsContentHitTestable())
+	{
+		RecordHitTestGeometry(Args, AllottedGeometry.GetLocalSize(), HitTestScale, PaintGeometry.DrawPosition);
+	}
+	else
+	{
+		FrontDeferredPaints = RecordedElements->GetDeferredPaintList();
+	}
+
+	LastHitTestRect = FSlateRect(PaintGeometry.DrawPosition, PaintGeometry.DrawPosition + RenderSize);
+
+	bTiledFrontValid = true;
+	TiledRedrawRestarts = 0;
+	NextTileToDraw = INDEX_NONE;
+
+	// Content that changed after the version was recorded is left for the next version.
+	if (!bRequestedDuringTiledRedraw)
+	{
+		FUIRetainerSchedulingPolicy::OnRedrawn(ScheduleState);
+		Shared_WaitingToRender.Remove(this);
+	}
+
+	LastDrawTime = FApp::GetCurrentTime();
+	RedrawCount++;
+
+	return true;
+}
+
+void SUIRetainerBoxWidget::PaintHitTestAndDeferred(const FPaintArgs& Args, FSlateWindowElementList& OutDrawElements, int32 LayerId) const
+{
+	if (RootCacheNode)
+	{
+		RootCacheNode->RecordHittestGeometry(Args.GetGrid(), Args.GetLastHitTestIndex(), LayerId, FVector2D(0, 0));
+	}
+
+	// Any deferred painted elements of the retainer should be drawn directly by the main renderer, not rendered into the render target,
+	// as most of those sorts of things will break the rendering rect, things like tooltips, and popup menus.
+	for (auto& DeferredPaint : FrontDeferredPaints)
+	{
+		OutDrawElements.QueueDeferredPainting(DeferredPaint->Copy(Args));
+	}
+}
+
+int32 SUIRetainerBoxWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	STAT(FScopeCycleCounter PaintCycleCounter(MyStatId);)
+
+		SUIRetainerBoxWidget* MutableThis = const_cast<SUIRetainerBoxWidget*>(this);
+
+	MutableThis->RefreshRenderingMode();
+	MutableThis->BuildDeferredContent();
+
+	// Frozen retainers have no content to fall back on, so their baked surface is shown even with retained rendering off.
+	const bool bShowFrozenSurface = bBakedSurfaceFrozen && RenderingResources->BakedSurface;
+
+	if ((bEnableUIRetainedRendering && (IsAnythingVisibleToRender() || ShouldShowBakedSurface())) || bShowFrozenSurface)
+	{
+		if (bEnableScreenSizeLOD)
+		{
+			// Work out how much of the retainer is actually on screen, used to pick the LOD tier.
+			const FSlateRect RenderBoundingRect = AllottedGeometry.GetRenderBoundingRect();
+			const FVector2D BoundingSize = RenderBoundingRect.GetSize();
+			const float BoundingArea = BoundingSize.X * BoundingSize.Y;
+
+			bool bOverlapping = false;
+			const FSlateRect VisibleRect = RenderBoundingRect.IntersectionWith(MyCullingRect, bOverlapping);
+			const FVector2D VisibleSize = VisibleRect.GetSize();
+
+			MutableThis->VisibleFraction = bOverlapping && BoundingArea > 0.f
+				? FMath::Clamp((VisibleSize.X * VisibleSize.Y) / BoundingArea, 0.f, 1.f)
+				: 0.f;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_SlateRetainerWidgetPaint);
+
+		TSharedRef<SUIRetainerBoxWidget> SharedMutableThis = SharedThis(MutableThis);
+
+		// Opaque rects published last frame are what the retainers painted this frame are tested against.
+		if (Shared_OccluderFrame != GFrameCounter)
+		{
+			Shared_OccluderFrame = GFrameCounter;
+			Exchange(Shared_OccludersLastFrame, Shared_OccludersThisFrame);
+			Shared_OccludersThisFrame.Reset();
+		}
+
+		const int32 PaintOrder = Shared_PaintOrderThisFrame.TryGetValue(0) + 1;
+		Shared_PaintOrderThisFrame = PaintOrder;
+
+		bool bOnScreen = false;
+		const FSlateRect VisibleRect = AllottedGeometry.GetRenderBoundingRect().IntersectionWith(MyCullingRect, bOnScreen);
+
+		// Publishes what we cover for the retainers painted before us, as long as nothing can show through.
+		// Rotated or sheared retainers don't cover their whole bounding rect, so they're left out.
+		auto PublishOccluder = [&](float Opacity)
+		{
+			float A, B, C, D;
+			AllottedGeometry.GetAccumulatedRenderTransform().GetMatrix().GetMatrix(A, B, C, D);
+
+			if (bOpaqueContent && bOnScreen && Opacity >= 1.f && B == 0.f && C == 0.f)
+			{
+				Shared_OccludersThisFrame.Add({ this, &Args.GetGrid(), VisibleRect, PaintOrder });
+			}
+		};
+
+		const bool bWasOccluded = bOccluded;
+		MutableThis->bOccluded = bOnScreen && IsOccluded(Shared_OccludersLastFrame, &Args.GetGrid(), VisibleRect, PaintOrder);
+
+		if (bWasOccluded && !bOccluded)
+		{
+			MutableThis->RequestRender();
+		}
+
+		// Skipping on last frame's occluders alone would show stale pixels on the frame the occluder goes away.
+		if (bOccluded)
+		{
+			MutableThis->OccludedRect = VisibleRect;
+			MutableThis->OccludedPaintOrder = PaintOrder;
+
+			OutDrawElements.QueueDeferredPainting(FSlateWindowElementList::FDeferredPaint(OcclusionCheck.ToSharedRef(), Args, AllottedGeometry, InWidgetStyle, bParentEnabled));
+		}
+
+		// Frozen retainers never draw their content, and lazy ones can't until it has been built.
+		if (!bBakedSurfaceFrozen && !DeferredContentBuilder && IsAnythingVisibleToRender())
+		{
+			MutableThis->PaintRetainedContent(Args, AllottedGeometry);
+		}
+
+		// An evicted surface that wasn't just drawn again comes back from system memory.
+		if (EvictionState == EEvictionState::Evicted)
+		{
+			MutableThis->RestoreEvictedSurface();
+		}
+
+		const bool bShowBakedSurface = ShouldShowBakedSurface();
+
+		if (bShowBakedSurface)
+		{
+			MutableThis->BakedSurfaceShownFrame = FMath::Min(BakedSurfaceShownFrame, GFrameCounter);
+		}
+		else if (bTiledFrontValid)
+		{
+			const FLinearColor ComputedColorAndOpacity(InWidgetStyle.GetColorAndOpacityTint() * ColorAndOpacity.Get());
+			const FLinearColor PremultipliedColorAndOpacity(ComputedColorAndOpacity * ComputedColorAndOpacity.A);
+
+			// Tiles are in surface pixels, which the retainer's local size is stretched over.
+			const FVector2D PixelToLocal = AllottedGeometry.GetLocalSize() / FVector2D(TiledSurfaceSize);
+
+			for (const FRetainedTile& Tile : Tiles)
+			{
+				FSlateDrawElement::MakeBox(
+					OutDrawElements,
+					LayerId,
+					AllottedGeometry.ToPaintGeometry(FVector2D(Tile.Rect.Min) * PixelToLocal, FVector2D(Tile.Rect.Size()) * PixelToLocal),
+					&Tile.FrontBrush,
+					ESlateDrawEffect::PreMultipliedAlpha | ESlateDrawEffect::NoGamma,
+					PremultipliedColorAndOpacity
+				);
+			}
+
+			// The tiles cover the whole retainer between them, so it occludes just like a single surface.
+			PublishOccluder(ComputedColorAndOpacity.A);
+
+			PaintHitTestAndDeferred(Args, OutDrawElements, LayerId);
+
+			return LayerId;
+		}
+		else if (EvictionState == EEvictionState::Restoring)
+		{
+			// The evicted surface is still being decompressed.  Painting the content instead would be the traversal the
+			// eviction saves, so nothing is drawn until it can be shown, the hit test geometry from before still works.
+			PaintHitTestAndDeferred(Args, OutDrawElements, LayerId);
+
+			return LayerId;
+		}
+		else if (bAsyncSurfaceCreation && IsSurfacePending())
+		{
+			// The retained surface is still being created, draw the content directly this frame instead.
+			return SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
+		}
+
+		const bool bShowRestoredSurface = !bShowBakedSurface && EvictionState == EEvictionState::Restored;
+
+		UTexture* SurfaceTexture = bShowBakedSurface ? static_cast<UTexture*>(RenderingResources->BakedSurface)
+			: bShowRestoredSurface ? static_cast<UTexture*>(RenderingResources->RestoredSurface)
+			: GetRenderTarget();
+
+		const FSlateBrush* Brush = bDynamicMaterialInUse ? &SurfaceBrush
+			: bShowBakedSurface ? &BakedSurfaceBrush
+			: bShowRestoredSurface ? &RestoredSurfaceBrush
+			: &SurfaceBrush;
+
+		if (SurfaceTexture->GetSurfaceWidth() >= 1 && SurfaceTexture->GetSurfaceHeight() >= 1)
+		{
+			const FLinearColor ComputedColorAndOpacity(InWidgetStyle.GetColorAndOpacityTint() * ColorAndOpacity.Get() * Brush->GetTint(InWidgetStyle));
+			const FLinearColor AdjustedColor(ComputedColorAndOpacity / ComputedColorAndOpacity.A);
+			const FLinearColor PremultipliedColorAndOpacity(ComputedColorAndOpacity * ComputedColorAndOpacity.A);
+
+			UMaterialInstanceDynamic* DynamicEffect = RenderingResources->DynamicEffect;
+
+			if (bDynamicMaterialInUse)
+			{
+				DynamicEffect->SetTextureParameterValue(DynamicEffectTextureParameter, SurfaceTexture);
+			}
+
+			FSlateDrawElement::MakeBox(
+				OutDrawElements,
+				LayerId,
+				AllottedGeometry.ToPaintGeometry(),
+				Brush,
+				ColourSpace == EUIRetainerBoxColourSpace::Linear && bDynamicMaterialInUse
+					? ESlateDrawEffect::None
+					: ESlateDrawEffect::PreMultipliedAlpha | ESlateDrawEffect::NoGamma,
+				ColourSpace == EUIRetainerBoxColourSpace::Linear && bDynamicMaterialInUse
+					? FLinearColor(AdjustedColor.R, AdjustedColor.G, AdjustedColor.B, ComputedColorAndOpacity.A)
+					: PremultipliedColorAndOpacity
+			);
+
+			// A dynamic material can make any of the surface see through.
+			if (!bDynamicMaterialInUse)
+			{
+				PublishOccluder(ComputedColorAndOpacity.A);
+			}
+
+			PaintHitTestAndDeferred(Args, OutDrawElements, LayerId);
+		}
+
+		return LayerId;
+	}
+
+	return SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
+}
+
+FVector2D SUIRetainerBoxWidget::ComputeDesiredSize(float LayoutScaleMuliplier) const
+{
+	if (bBakedSurfaceFrozen)
+	{
+		// There's no content to measure, use the size the surface was baked at in slate units.
+		return BakedSurfaceBrush.ImageSize;
+	}
+	else if (bEnableUIRetainedRendering)
 	{
 		return MyWidget->GetDesiredSize();
 	}
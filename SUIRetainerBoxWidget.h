@@ -16,13 +16,23 @@
 #include "Input/HittestGrid.h"
 #include "Slate/WidgetRenderer.h"
 #include "Misc/FrameValue.h"
+#include "RenderCommandFence.h"
 #include "UIRetainerBoxTypes.h"
+#include "UIRetainerBoxReadback.h"
+#include "UIRetainerSchedulingPolicy.h"
+#include "UIRetainerGroupState.h"
 
 class FArrangedChildren;
 class UMaterialInstanceDynamic;
 class UMaterialInterface;
 class UTextureRenderTarget2D;
+class UTexture2D;
 class FUIRetainerBoxWidgetRenderingResources;
+class FUIRetainerBoxSharedSurface;
+class FSlateRenderDataHandle;
+class SUIRetainerBoxElementReplay;
+class SUIRetainerBoxOcclusionCheck;
+struct FUIRetainerBoxEvictionJob;
 
 DECLARE_MULTICAST_DELEGATE(FOnUIRetainedModeChanged);
 
@@ -31,6 +41,9 @@ class UI_API SUIRetainerBoxWidget : public SCompoundWidget, public ILayoutCache
 public:
 	static int32 Shared_MaxRetainerWorkPerFrame;
 
+	/** Measures the prepass and paint of every redraw even while no trace or timeline is capturing them. */
+	static bool Shared_MeasureRedrawTimings;
+
 public:
 	SLATE_BEGIN_ARGS(SUIRetainerBoxWidget)
 	{
@@ -63,6 +76,12 @@ public:
 
 	void SetRetainedRendering(bool bRetainRendering);
 
+	/**
+	 * Reads the retained surface back to the CPU after its next redraw, without blocking.  The callback fires
+	 * on the game thread a few frames later.  Under NullRHI the result holds the drawn elements instead of pixels.
+	 */
+	void RequestReadback(const FOnUIRetainerBoxReadbackComplete& OnComplete);
+
 	void SetContent(const TSharedRef< SWidget >& InContent);
 
 	UMaterialInstanceDynamic* GetEffectMaterial() const;
@@ -83,10 +102,98 @@ public:
 
 	virtual bool PaintRetainedContent(const FPaintArgs& Args, const FGeometry& AllottedGeometry);
 
+	/** Gets the name the retainer was given for stats and traces. */
+	FName GetStatName() const { return StatName; }
+
 	void SetWorld(UWorld* World);
 
 	void SetColourSpace(EUIRetainerBoxColourSpace InColourSpace);
 
+	/**
+	 * Shares the retained surface with every other retainer using the same key, size and content version.
+	 * Only one of them redraws the shared surface each frame, the rest just composite it.
+	 */
+	void SetSurfaceKey(FName InSurfaceKey, int32 InContentVersion);
+
+	/**
+	 * When enabled render targets are created without blocking on the rendering thread, and the content is
+	 * painted directly until the retained surface is ready.
+	 */
+	void SetAsyncSurfaceCreation(bool bInAsyncSurfaceCreation);
+
+	/** Starts creating the retained surface at the given size in pixels ahead of the first draw. */
+	void PrewarmSurface(FIntPoint Size);
+
+	/** Gets the render target the retained content is currently drawn into. */
+	UTextureRenderTarget2D* GetRenderTarget() const;
+
+	/** Gets the number of times the retained content has been redrawn. */
+	int32 GetRedrawCount() const { return RedrawCount; }
+
+	/**
+	 * Gets how long creating the render target, the prepass and the paint of the last redraw took in milliseconds,
+	 * only measured while something captures them.
+	 */
+	double GetLastSurfaceCreationMs() const { return LastSurfaceCreationMs; }
+	double GetLastPrepassMs() const { return LastPrepassMs; }
+	double GetLastPaintMs() const { return LastPaintMs; }
+
+	/**
+	 * Shows a surface baked ahead of time until the content is first drawn.  Frozen retainers only ever show
+	 * the baked surface and never draw their content.
+	 */
+	void SetBakedSurface(UTexture2D* InBakedSurface, bool bInFrozen);
+
+	/** Holds off building deferred content until SetBakedSurface is called with the surface being loaded, or null if there is none. */
+	void SetBakedSurfaceLoading();
+
+	/**
+	 * Marks the content as fully covering the retainer.  Opaque retainers stop the retainers painted
+	 * underneath them from redrawing while they're completely covered.
+	 */
+	void SetOpaqueContent(bool bInOpaqueContent);
+
+	/**
+	 * Draws the content at a reference render transform scale and composites it with the actual transform,
+	 * so scale animations don't redraw every frame.  With a ReferenceScale of 0 the peak scale seen is used.
+	 * The content is only redrawn at the current scale once it's further than QualityBand from the reference.
+	 */
+	void SetTransformTolerance(bool bInTransformTolerant, float InReferenceScale, float InQualityBand);
+
+	/** Makes the retainer a member of the group, or of no group if null. */
+	void SetGroup(const TSharedPtr<FUIRetainerGroupState>& InGroup);
+
+	/** Sets a function to build the content with once the baked surface has been shown. */
+	void SetDeferredContent(TFunction<TSharedRef<SWidget>()> InContentBuilder);
+
+	/** Gets the counts of accepted and ignored invalidations from the content. */
+	const FUIRetainerBoxInvalidationStats& GetInvalidationStats() const { return InvalidationStats; }
+
+	/** Enables screen size based level of detail, picking refresh interval and resolution from the given tiers. */
+	void SetScreenSizeLOD(bool bInEnableScreenSizeLOD, const TArray<FUIRetainerBoxLODTier>& InLODTiers);
+
+	/**
+	 * Keeps the render data from the last paint of the content.  Redraws caused only by the output changing,
+	 * like a colour space switch, draw that again instead of painting the widgets.
+	 */
+	void SetReplayElementsOnOutputChange(bool bInReplayElements);
+
+	/**
+	 * Splits surfaces larger than a tile into tiles of TileSize pixels, redrawing at most MaxTilesPerFrame of
+	 * them a frame.  The last complete version stays on screen until every tile of the new one is drawn.
+	 */
+	void SetTiledRedraw(bool bInTiledRedraw, int32 InTileSize, int32 InMaxTilesPerFrame);
+
+	/**
+	 * Reads the retained surface back, compresses it on a worker thread and releases the render target.  The
+	 * next time the retainer is shown the surface is restored from system memory instead of being redrawn.
+	 * Nothing is drawn while it's being restored, and only a requested redraw replaces it, not a phase refresh.
+	 */
+	void EvictSurface();
+
+	/** Gets the compressed size of the evicted surface and how long compressing and restoring it took. */
+	const FUIRetainerBoxEvictionStats& GetEvictionStats() const { return EvictionStats; }
+
 protected:
 	// BEGIN SLeafWidget interface
 	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
@@ -98,6 +205,48 @@ protected:
 	bool IsAnythingVisibleToRender() const;
 	void OnRetainerModeChanged();
 	void OnGlobalInvalidate();
+
+	/** Returns the LOD tier for the given render size, or null if the retainer should draw at full rate and resolution. */
+	const FUIRetainerBoxLODTier* ChooseLODTier(const FVector2D& InRenderSize);
+
+	enum class EInvalidationClass : uint8
+	{
+		Accepted,
+		Hidden
+	};
+
+	/** True if the baked surface should be shown instead of the render target. */
+	bool ShouldShowBakedSurface() const;
+
+	/** Builds deferred content once the baked surface has been on screen for a frame. */
+	void BuildDeferredContent();
+
+	/** Picks the render transform scale to draw the content at when transform tolerant. */
+	float ChooseTransformScale(float CurrentScale);
+
+	/** A screen rect covered by an opaque retainer, and where it came in the paint order. */
+	struct FOccluder
+	{
+		const SUIRetainerBoxWidget* Retainer;
+		const FHittestGrid* PaintGrid;
+		FSlateRect Rect;
+		int32 PaintOrder;
+	};
+
+	/** True if the visible rect is entirely covered by one of the opaque retainers painted after us. */
+	bool IsOccluded(const TArray<FOccluder>& Occluders, const FHittestGrid* PaintGrid, const FSlateRect& VisibleRect, int32 PaintOrder) const;
+
+	/** Run once the whole window is painted, draws after all if what covered us last frame no longer does. */
+	void ResolveOcclusion(const FPaintArgs& Args, const FGeometry& AllottedGeometry);
+
+	/** Records a scheduling decision to the trace and timeline, if either is capturing. */
+	void RecordScheduleEvent(const FUIRetainerScheduleInput& Input, bool bRequested, const FUIRetainerScheduleResult& Result, bool bPainted, double StartTime, double PaintCostMs, const FVector2D& RenderSize);
+
+	/** Works out whether an invalidation from the given widget could change the retained pixels. */
+	EInvalidationClass ClassifyInvalidation(const SWidget* InvalidateWidget) const;
+
+	/** True if redraws should be timed, which is only while something captures the timings. */
+	static bool ShouldMeasureTimings();
 private:
 #if !UE_BUILD_SHIPPING
 	static void OnRetainerModeCVarChanged(IConsoleVariable* CVar);
@@ -107,10 +256,72 @@ private:
 
 	mutable FSlateBrush SurfaceBrush;
 
-	mutable FVector2D PreviousRenderSize;
-
 	void UpdateWidgetRenderer();
 
+	/** Redraws the retained content once the scheduling policy has decided it should be. */
+	bool DrawRetainedContent(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FPaintGeometry& PaintGeometry, const FVector2D& RenderSize, float ContentScale, float HitTestScale);
+
+	bool ShouldWriteContentInGammaSpace() const;
+
+	void AcquireSharedSurface(uint32 Width, uint32 Height);
+	void ReleaseSharedSurface();
+
+	/** Paints the window without drawing it anywhere, keeping the hit test geometry and deferred paints up to date. */
+	void PaintWindowElements(const FPaintArgs& PaintArgs, const FGeometry& WindowGeometry, FSlateWindowElementList& OutElementList);
+
+	/**
+	 * Paints the window at the scale it's shown at, recording the hit test geometry and deferred paints, for when
+	 * the content is drawn into the target at a different scale.
+	 */
+	void RecordHitTestGeometry(const FPaintArgs& Args, const FVector2D& LocalSize, float HitTestScale, const FVector2D& DrawPosition);
+
+	/** Starts reading back the given target, which holds this frame's draw, for every pending readback. */
+	void ServicePendingReadbacks(UTextureRenderTarget2D* RenderTarget);
+
+	/** True while the render target we draw into is still being created on the rendering thread. */
+	bool IsSurfacePending() const;
+
+	/** True if our content can be hit tested, otherwise there's no point recording its hit test geometry. */
+	bool IsContentHitTestable() const;
+
+	/** Requests a redraw for a change that doesn't affect the content, so the recorded elements can be replayed. */
+	void RequestReplay();
+
+	/** Paints the window into the recorded element list and caches its render data. */
+	void RecordElements(const FPaintArgs& PaintArgs, const FGeometry& WindowGeometry, const FVector2D& DrawPosition, FIntPoint DrawSize);
+
+	/** Creates the window the recorded render data is replayed through, if there isn't one yet. */
+	void CreateReplayWindow();
+
+	/** Draws the recorded render data into the render target, offset to the current draw position. */
+	void DrawRecordedElements(const FPaintArgs& PaintArgs, UTextureRenderTarget2D* RenderTarget, const FGeometry& WindowGeometry, const FVector2D& DrawPosition, double DeltaTime);
+
+	/** Pushes the current world's scene to the renderer and counts the redraw against the frame budgets. */
+	void BeginRetainerWork(bool bCountWork);
+
+	/** True if a surface of the given size should be redrawn a few tiles at a time. */
+	bool ShouldDrawTiled(const FVector2D& RenderSize) const;
+
+	/** Draws the next tiles of the new version, and shows it once all of them are drawn. */
+	bool DrawRetainedContentTiled(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FPaintGeometry& PaintGeometry, const FVector2D& RenderSize, float ContentScale, float HitTestScale);
+
+	/** Splits a surface of the given size into tiles, each with a front and back render target. */
+	void LayoutTiles(FIntPoint SurfaceSize);
+	void ReleaseTiles();
+
+	/** Keeps the compressed surface once its worker is done, unless the content was redrawn since the eviction. */
+	void OnEvictedSurfaceReadback(FUIRetainerBoxReadbackResult& Result, int32 Serial);
+	void FinishEviction(FUIRetainerBoxEvictionJob& Job);
+	static bool TickEviction(float DeltaTime, TWeakPtr<SUIRetainerBoxWidget> WeakRetainer, TSharedRef<FUIRetainerBoxEvictionJob, ESPMode::ThreadSafe> Job);
+
+	/** Decompresses the evicted surface on a worker thread, and shows it in place of the render target once it's done. */
+	void RestoreEvictedSurface();
+	void FinishRestore(FUIRetainerBoxEvictionJob& Job);
+	void DiscardEvictedSurface();
+
+	/** Records the hit test geometry and queues the deferred paints of the last drawn content. */
+	void PaintHitTestAndDeferred(const FPaintArgs& Args, FSlateWindowElementList& OutDrawElements, int32 LayerId) const;
+
 	mutable TSharedPtr<SWidget> MyWidget;
 
 	bool bEnableUIRetainedRenderingDesire;
@@ -122,16 +333,23 @@ private:
 	bool RenderOnPhase;
 	bool RenderOnInvalidation;
 
-	bool bRenderRequested;
+	/** Pending requests, last drawn frame and size, used by the scheduling policy. */
+	FUIRetainerScheduleState ScheduleState;
+
+	/** True if something requested a redraw since the retainer was last painted, recorded in traces. */
+	bool bRequestedSinceLastPaint = true;
+
+	/** True if the content may have changed since the elements were last recorded. */
+	bool bContentDirty = true;
 
 	double LastDrawTime;
-	int64 LastTickedFrame;
 
 	TSharedPtr<SVirtualWindow> Window;
 	TWeakObjectPtr<UWorld> OuterWorld;
 
 	FUIRetainerBoxWidgetRenderingResources* RenderingResources;
 
+	FName StatName;
 	STAT(TStatId MyStatId;)
 
 	FSlateBrush DynamicBrush;
@@ -141,6 +359,12 @@ private:
 	static TArray<SUIRetainerBoxWidget*, TInlineAllocator<3>> Shared_WaitingToRender;
 	static TFrameValue<int32> Shared_RetainerWorkThisFrame;
 
+	/** Opaque rects published this frame, and the ones from last frame retainers are tested against. */
+	static TArray<FOccluder> Shared_OccludersThisFrame;
+	static TArray<FOccluder> Shared_OccludersLastFrame;
+	static uint64 Shared_OccluderFrame;
+	static TFrameValue<int32> Shared_PaintOrderThisFrame;
+
 	mutable FCachedWidgetNode* RootCacheNode;
 	mutable TArray< FCachedWidgetNode* > NodePool;
 	mutable int32 LastUsedCachedNodeIndex;
@@ -148,4 +372,151 @@ private:
 	EUIRetainerBoxColourSpace ColourSpace = EUIRetainerBoxColourSpace::Linear;
 
 	bool bDynamicMaterialInUse = false;
+
+	bool bEnableScreenSizeLOD = false;
+
+	/** LOD tiers, sorted by ascending MaxScreenSize. */
+	TArray<FUIRetainerBoxLODTier> LODTiers;
+
+	/** The index of the tier in use, LODTiers.Num() for full rate and resolution, or INDEX_NONE before the first pick. */
+	int32 CurrentLODTier = INDEX_NONE;
+
+	FName SurfaceKey;
+	int32 SurfaceContentVersion = 0;
+	TSharedPtr<FUIRetainerBoxSharedSurface> SharedSurface;
+
+	bool bAsyncSurfaceCreation = false;
+	FRenderCommandFence SurfaceCreationFence;
+
+	int32 RedrawCount = 0;
+
+	/** How long creating the render target, the prepass and the paint of the last redraw took. */
+	double LastSurfaceCreationMs = 0.0;
+	double LastPrepassMs = 0.0;
+	double LastPaintMs = 0.0;
+
+	/** Readbacks waiting on the next redraw. */
+	TArray<FOnUIRetainerBoxReadbackComplete> PendingReadbacks;
+
+	/** The rect and scale our hit test geometry was last recorded for. */
+	FSlateRect LastHitTestRect;
+	float LastHitTestScale = 0.f;
+
+	FUIRetainerBoxInvalidationStats InvalidationStats;
+
+	FSlateBrush BakedSurfaceBrush;
+	bool bBakedSurfaceFrozen = false;
+	bool bBakedSurfaceLoading = false;
+
+	/** The frame the baked surface was first shown on. */
+	uint64 BakedSurfaceShownFrame = MAX_uint64;
+
+	TFunction<TSharedRef<SWidget>()> DeferredContentBuilder;
+
+	TSharedPtr<FUIRetainerGroupState> Group;
+
+	bool bOpaqueContent = false;
+
+	bool bTransformTolerant = false;
+	float TransformReferenceScale = 0.f;
+	float TransformQualityBand = 0.25f;
+
+	/** The render transform scale drawn at while using the peak scale, which catches up with the largest one seen. */
+	float PeakTransformScale = 0.f;
+	float MaxTransformScale = 0.f;
+
+	/** The render transform scale of the last paint, to tell when an animation has settled. */
+	float LastTransformScale = 0.f;
+
+	/** True while we're covered by opaque retainers and not redrawing. */
+	bool bOccluded = false;
+
+	/** Where we were painted while occluded, to check against the occluders of the same frame. */
+	FSlateRect OccludedRect;
+	int32 OccludedPaintOrder = 0;
+	TSharedPtr<SUIRetainerBoxOcclusionCheck> OcclusionCheck;
+
+	/** The scheduling event of a paint while occluded, recorded once the occlusion is resolved. */
+	bool bOccludedEventPending = false;
+	bool bPendingOccludedRequested = false;
+	FUIRetainerScheduleInput PendingOccludedInput;
+	FVector2D PendingOccludedRenderSize = FVector2D::ZeroVector;
+
+	/** Our slot in the group, used to pick a phase when the group sets the refresh rate. */
+	int32 GroupSlot = 0;
+
+	/** The fraction of the retainer inside the culling rect the last time it was painted. */
+	float VisibleFraction = 1.f;
+
+	bool bReplayElementsOnOutputChange = false;
+
+	/** The element list the content was last painted into, and the render data cached from it. */
+	TSharedPtr<FSlateWindowElementList> RecordedElements;
+	TSharedPtr<FSlateRenderDataHandle, ESPMode::ThreadSafe> RecordedRenderData;
+	FVector2D RecordedDrawPosition;
+	FIntPoint RecordedSize;
+	float RecordedScale = 0.f;
+
+	/** Window drawn into the render target in place of our own when replaying the recorded render data. */
+	TSharedPtr<SVirtualWindow> ReplayWindow;
+	TSharedPtr<SUIRetainerBoxElementReplay> ReplayWidget;
+
+	bool bTiledRedraw = false;
+	int32 TileSize = 512;
+	int32 MaxTilesPerFrame = 4;
+
+	/** A piece of the surface in pixels, and its targets in the rendering resources. */
+	struct FRetainedTile
+	{
+		FIntRect Rect;
+		int32 FrontTarget;
+		int32 BackTarget;
+		FSlateBrush FrontBrush;
+	};
+
+	TArray<FRetainedTile> Tiles;
+	FIntPoint TiledSurfaceSize = FIntPoint::ZeroValue;
+
+	/** True once every tile of a version has been drawn, so the front targets can be shown. */
+	bool bTiledFrontValid = false;
+
+	/** The next tile of the version being drawn, or INDEX_NONE if there isn't one. */
+	int32 NextTileToDraw = INDEX_NONE;
+
+	/** True if a redraw was requested after the version being drawn was recorded, which then starts over. */
+	bool bRequestedDuringTiledRedraw = false;
+
+	/** How many times in a row the version being drawn has started over. */
+	int32 TiledRedrawRestarts = 0;
+
+	/** The most times a version starts over for new content before it's finished as recorded. */
+	static const int32 MaxTiledRedrawRestarts = 2;
+
+	/**
+	 * Deferred paints of the content on screen.  Every draw replaces the widget renderer's own list, including
+	 * each tile of a version that isn't shown yet, so this only changes along with what's shown.
+	 */
+	decltype(FWidgetRenderer::DeferredPaints) FrontDeferredPaints;
+
+	enum class EEvictionState : uint8
+	{
+		None,
+		Pending,
+		Evicted,
+		Restoring,
+		Restored
+	};
+
+	EEvictionState EvictionState = EEvictionState::None;
+
+	/** Bumped whenever the eviction is discarded, so readbacks and workers from before it are ignored. */
+	int32 EvictionSerial = 0;
+
+	/** The zlib compressed pixels of the evicted surface. */
+	TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> EvictedSurfaceData;
+	FIntPoint EvictedSurfaceSize = FIntPoint::ZeroValue;
+
+	FUIRetainerBoxEvictionStats EvictionStats;
+
+	FSlateBrush RestoredSurfaceBrush;
 };
@@ -1,13 +1,32 @@
 #include "UIRetainerBox.h"
 #include "Widgets/SNullWidget.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/WidgetTree.h"
+#include "Blueprint/WidgetLayoutLibrary.h"
+#include "Engine/Texture2D.h"
+#include "Misc/PackageName.h"
+#include "Misc/Crc.h"
+#include "UObject/UObjectGlobals.h"
 
 #include "SUIRetainerBoxWidget.h"
+#include "UIRetainerGroup.h"
 
 #define LOCTEXT_NAMESPACE "UMG"
 
 static FName DefaultTextureParameterName("Texture");
 
+/** The folder baked retainer surfaces are saved to. */
+static const TCHAR* BakedSurfaceFolder = TEXT("/Game/BakedUIRetainers");
+
+/** True if retainer boxes should use surfaces baked for them. */
+int32 GUseBakedUIRetainerSurfaces = 1;
+FAutoConsoleVariableRef UseBakedUIRetainerSurfaces(
+	TEXT("Slate.UseBakedUIRetainerSurfaces"),
+	GUseBakedUIRetainerSurfaces,
+	TEXT("Whether retainer boxes show surfaces baked ahead of time, takes effect when their widgets are rebuilt.")
+);
+
 /////////////////////////////////////////////////////
 // URetainerBox
 
@@ -19,6 +38,20 @@ UUIRetainerBox::UUIRetainerBox(const FObjectInitializer& ObjectInitializer)
 	PhaseCount = 1;
 	RenderOnPhase = true;
 	RenderOnInvalidation = false;
+	bEnableScreenSizeLOD = false;
+	SurfaceContentVersion = 0;
+	bAsyncSurfaceCreation = false;
+	bReplayElementsOnOutputChange = false;
+	bOpaqueContent = false;
+	bTransformTolerant = false;
+	TransformReferenceScale = 0.f;
+	TransformQualityBand = 0.25f;
+	bTiledRedraw = false;
+	TileSize = 512;
+	TilesPerFrame = 4;
+	BakeMode = EUIRetainerBoxBakeMode::None;
+	BakedSurface = nullptr;
+	RetainerGroup = nullptr;
 	TextureParameter = DefaultTextureParameterName;
 }
 
@@ -83,11 +116,156 @@ void UUIRetainerBox::SetTextureParameter(FName InTextureParameter)
 	}
 }
 
+void UUIRetainerBox::SetScreenSizeLOD(bool bInEnableScreenSizeLOD, const TArray<FUIRetainerBoxLODTier>& InLODTiers)
+{
+	bEnableScreenSizeLOD = bInEnableScreenSizeLOD;
+	LODTiers = InLODTiers;
+	if (MyRetainerWidget.IsValid())
+	{
+		MyRetainerWidget->SetScreenSizeLOD(bEnableScreenSizeLOD, LODTiers);
+	}
+}
+
+void UUIRetainerBox::SetSurfaceKey(FName InSurfaceKey, int32 InContentVersion)
+{
+	SurfaceKey = InSurfaceKey;
+	SurfaceContentVersion = InContentVersion;
+	if (MyRetainerWidget.IsValid())
+	{
+		MyRetainerWidget->SetSurfaceKey(SurfaceKey, SurfaceContentVersion);
+	}
+}
+
+void UUIRetainerBox::PrewarmSurface(FVector2D Size)
+{
+	TakeWidget();
+
+	if (MyRetainerWidget.IsValid())
+	{
+		MyRetainerWidget->PrewarmSurface(FIntPoint(FMath::RoundToInt(Size.X), FMath::RoundToInt(Size.Y)));
+	}
+}
+
+/** Calls the callback for every retainer box in the widget, its children and any user widgets nested inside it. */
+static void ForEachRetainerBox(UWidget* RootWidget, TFunctionRef<void(UUIRetainerBox*)> Callback)
+{
+	auto VisitWidget = [&Callback](UWidget* Widget)
+	{
+		if (Cast<UUserWidget>(Widget))
+		{
+			ForEachRetainerBox(Widget, Callback);
+		}
+		else if (UUIRetainerBox* RetainerBox = Cast<UUIRetainerBox>(Widget))
+		{
+			Callback(RetainerBox);
+		}
+	};
+
+	if (UUserWidget* UserWidget = Cast<UUserWidget>(RootWidget))
+	{
+		if (UserWidget->WidgetTree)
+		{
+			UserWidget->WidgetTree->ForEachWidget(VisitWidget);
+		}
+	}
+	else
+	{
+		if (UUIRetainerBox* RetainerBox = Cast<UUIRetainerBox>(RootWidget))
+		{
+			Callback(RetainerBox);
+		}
+
+		UWidgetTree::ForWidgetAndChildren(RootWidget, VisitWidget);
+	}
+}
+
+void UUIRetainerBox::PrewarmSurfacesInWidget(UWidget* RootWidget)
+{
+	if (!RootWidget)
+	{
+		return;
+	}
+
+	const float ViewportScale = UWidgetLayoutLibrary::GetViewportScale(RootWidget);
+
+	ForEachRetainerBox(RootWidget, [ViewportScale](UUIRetainerBox* RetainerBox)
+	{
+		TSharedRef<SWidget> SlateWidget = RetainerBox->TakeWidget();
+		SlateWidget->SlatePrepass(ViewportScale);
+
+		RetainerBox->PrewarmSurface(SlateWidget->GetDesiredSize() * ViewportScale);
+	});
+}
+
+void UUIRetainerBox::RequestReadback(FOnUIRetainerBoxReadback OnComplete)
+{
+	if (MyRetainerWidget.IsValid())
+	{
+		MyRetainerWidget->RequestReadback(FOnUIRetainerBoxReadbackComplete::CreateLambda([OnComplete](const FUIRetainerBoxReadbackResult& Result)
+		{
+			OnComplete.ExecuteIfBound(Result);
+		}));
+	}
+	else
+	{
+		// Without a widget there's nothing to read back, but callers still expect to hear back.
+		OnComplete.ExecuteIfBound(FUIRetainerBoxReadbackResult());
+	}
+}
+
+FUIRetainerBoxInvalidationStats UUIRetainerBox::GetInvalidationStats() const
+{
+	if (MyRetainerWidget.IsValid())
+	{
+		return MyRetainerWidget->GetInvalidationStats();
+	}
+
+	return FUIRetainerBoxInvalidationStats();
+}
+
+void UUIRetainerBox::EvictRetainedSurface()
+{
+	if (MyRetainerWidget.IsValid())
+	{
+		MyRetainerWidget->EvictSurface();
+	}
+}
+
+FUIRetainerBoxEvictionStats UUIRetainerBox::GetEvictionStats() const
+{
+	if (MyRetainerWidget.IsValid())
+	{
+		return MyRetainerWidget->GetEvictionStats();
+	}
+
+	return FUIRetainerBoxEvictionStats();
+}
+
+void UUIRetainerBox::SetRetainerGroup(UUIRetainerGroup* InRetainerGroup)
+{
+	RetainerGroup = InRetainerGroup;
+
+	// An explicit group replaces the named one, otherwise the next property sync would join it again.
+	RetainerGroupName = NAME_None;
+
+	if (MyRetainerWidget.IsValid())
+	{
+		MyRetainerWidget->SetGroup(RetainerGroup ? RetainerGroup->GetState() : TSharedPtr<FUIRetainerGroupState>());
+	}
+}
+
+UUIRetainerGroup* UUIRetainerBox::GetRetainerGroup() const
+{
+	return RetainerGroup;
+}
+
 void UUIRetainerBox::ReleaseSlateResources(bool bReleaseChildren)
 {
 	Super::ReleaseSlateResources(bReleaseChildren);
 
 	MyRetainerWidget.Reset();
+	BakedSurface = nullptr;
+	BakedSurfaceLoadRequest++;
 }
 
 TSharedRef<SWidget> UUIRetainerBox::RebuildWidget()
@@ -105,14 +283,71 @@ TSharedRef<SWidget> UUIRetainerBox::RebuildWidget()
 
 	MyRetainerWidget->SetRetainedRendering(IsDesignTime() ? false : true);
 
+	BakedSurface = nullptr;
+	BakedSurfaceLoadRequest++;
+
+	bool bLoadingBakedSurface = false;
+
+	if (BakeMode != EUIRetainerBoxBakeMode::None && GUseBakedUIRetainerSurfaces && !IsDesignTime())
+	{
+		const FString PackageName = GetBakedSurfacePackageName();
+		BakedSurface = FindObject<UTexture2D>(nullptr, *(PackageName + TEXT(".") + FPackageName::GetShortName(PackageName)));
+
+		// Loading synchronously would hitch whatever is building the widget, so load in the background.
+		if (!BakedSurface && FPackageName::DoesPackageExist(PackageName))
+		{
+			bLoadingBakedSurface = true;
+			LoadPackageAsync(PackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UUIRetainerBox::OnBakedSurfaceLoaded, BakedSurfaceLoadRequest));
+		}
+	}
+
+	MyRetainerWidget->SetBakedSurface(BakedSurface, BakeMode == EUIRetainerBoxBakeMode::Frozen);
+
+	// Frozen content waits to find out whether there's a surface to show instead.  Lazy content doesn't,
+	// it's built straight away if the surface isn't ready by the first paint.
+	if (bLoadingBakedSurface && BakeMode == EUIRetainerBoxBakeMode::Frozen)
+	{
+		MyRetainerWidget->SetBakedSurfaceLoading();
+	}
+
 	if (GetChildrenCount() > 0)
 	{
-		MyRetainerWidget->SetContent(GetContentSlot()->Content ? GetContentSlot()->Content->TakeWidget() : SNullWidget::NullWidget);
+		if (BakedSurface && BakeMode == EUIRetainerBoxBakeMode::Frozen)
+		{
+			// Frozen content is never shown, so don't build it.
+		}
+		else if (BakedSurface || (bLoadingBakedSurface && BakeMode == EUIRetainerBoxBakeMode::Frozen))
+		{
+			TWeakObjectPtr<UUIRetainerBox> WeakThis(this);
+			MyRetainerWidget->SetDeferredContent([WeakThis]() -> TSharedRef<SWidget>
+			{
+				UWidget* Content = WeakThis.IsValid() ? WeakThis->GetContent() : nullptr;
+				return Content ? Content->TakeWidget() : SNullWidget::NullWidget;
+			});
+		}
+		else
+		{
+			MyRetainerWidget->SetContent(GetContentSlot()->Content ? GetContentSlot()->Content->TakeWidget() : SNullWidget::NullWidget);
+		}
 	}
 
 	return MyRetainerWidget.ToSharedRef();
 }
 
+void UUIRetainerBox::OnBakedSurfaceLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result, uint32 LoadRequest)
+{
+	// The widget may have been rebuilt or released since the load was started.
+	if (LoadRequest != BakedSurfaceLoadRequest || !MyRetainerWidget.IsValid())
+	{
+		return;
+	}
+
+	BakedSurface = LoadedPackage ? FindObject<UTexture2D>(LoadedPackage, *FPackageName::GetShortName(PackageName)) : nullptr;
+
+	// Without a surface frozen retainers go back to building and drawing their content.
+	MyRetainerWidget->SetBakedSurface(BakedSurface, BakeMode == EUIRetainerBoxBakeMode::Frozen);
+}
+
 void UUIRetainerBox::SynchronizeProperties()
 {
 	Super::SynchronizeProperties();
@@ -121,6 +356,20 @@ void UUIRetainerBox::SynchronizeProperties()
 	MyRetainerWidget->SetTextureParameter(TextureParameter);
 	MyRetainerWidget->SetWorld(GetWorld());
 	MyRetainerWidget->SetColourSpace(ColourSpace);
+	MyRetainerWidget->SetScreenSizeLOD(bEnableScreenSizeLOD, LODTiers);
+	MyRetainerWidget->SetSurfaceKey(SurfaceKey, SurfaceContentVersion);
+	MyRetainerWidget->SetAsyncSurfaceCreation(bAsyncSurfaceCreation);
+	MyRetainerWidget->SetReplayElementsOnOutputChange(bReplayElementsOnOutputChange);
+	MyRetainerWidget->SetOpaqueContent(bOpaqueContent);
+	MyRetainerWidget->SetTransformTolerance(bTransformTolerant, TransformReferenceScale, TransformQualityBand);
+	MyRetainerWidget->SetTiledRedraw(bTiledRedraw, TileSize, TilesPerFrame);
+
+	if (!RetainerGroup && RetainerGroupName != NAME_None && !IsDesignTime())
+	{
+		RetainerGroup = UUIRetainerGroup::FindOrCreateNamedGroup(RetainerGroupName);
+	}
+
+	MyRetainerWidget->SetGroup(RetainerGroup ? RetainerGroup->GetState() : TSharedPtr<FUIRetainerGroupState>());
 }
 
 void UUIRetainerBox::OnSlotAdded(UPanelSlot* InSlot)
@@ -161,6 +410,15 @@ const FGeometry& UUIRetainerBox::GetCachedAllottedGeometry() const
 	return TempGeo;
 }
 
+FString UUIRetainerBox::GetBakedSurfacePackageName() const
+{
+	const UUserWidget* OwningWidget = GetTypedOuter<UUserWidget>();
+	const UObject* Owner = OwningWidget ? static_cast<const UObject*>(OwningWidget->GetClass()) : GetOuter();
+
+	// Widgets with the same name can live in different folders, so the owner's full path is hashed in.
+	return FString::Printf(TEXT("%s/%s_%08X_%s"), BakedSurfaceFolder, *Owner->GetName(), FCrc::StrCrc32(*Owner->GetPathName()), *GetName());
+}
+
 /////////////////////////////////////////////////////
 
 #undef LOCTEXT_NAMESPACE
@@ -10,6 +10,10 @@
 class SUIRetainerBoxWidget;
 class UMaterialInstanceDynamic;
 class UMaterialInterface;
+class UTexture2D;
+class UUIRetainerGroup;
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnUIRetainerBoxReadback, const FUIRetainerBoxReadbackResult&, Result);
 
 /**
  * The Retainer Box renders children widgets to a render target first before
@@ -68,6 +72,108 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = ColourSpace)
 	EUIRetainerBoxColourSpace ColourSpace;
 
+	/**
+	 * Should this widget lower its refresh rate and resolution based on how large it is on screen.
+	 * Retainers that are completely culled will not redraw at all while this is enabled.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = LOD)
+	bool bEnableScreenSizeLOD;
+
+	/**
+	 * The LOD tiers to choose from when screen size LOD is enabled. The tier with the smallest
+	 * MaxScreenSize that still covers the effective on-screen size of the retainer is used, if none
+	 * cover it the retainer draws at the full rate and resolution set by the Phase and PhaseCount.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = LOD, meta = (EditCondition = "bEnableScreenSizeLOD"))
+	TArray<FUIRetainerBoxLODTier> LODTiers;
+
+	/**
+	 * Retainers with the same surface key, size and content version share a single render target, which is
+	 * only redrawn once a frame no matter how many of them there are.  Only use this when the retained
+	 * content is identical between all of them, each instance still hit tests its own widgets.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Instancing)
+	FName SurfaceKey;
+
+	/**
+	 * The version of the shared content, bump this on every retainer sharing the surface when the content changes.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Instancing)
+	int32 SurfaceContentVersion;
+
+	/**
+	 * Should render targets be created without waiting on the rendering thread.  While the render target
+	 * is being created the content is drawn directly instead, avoiding a hitch on the first draw.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = RenderRules)
+	bool bAsyncSurfaceCreation;
+
+	/**
+	 * Should the render data of the last paint be kept, so that redraws caused only by the output changing,
+	 * like switching colour space, don't need to paint the content again.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = RenderRules)
+	bool bReplayElementsOnOutputChange;
+
+	/**
+	 * Set when the content fully covers the retainer with nothing showing through.  Retainers painted
+	 * underneath an opaque retainer stop redrawing while it completely covers them.  Ignored while an effect
+	 * material is used or the retainer isn't fully opaque.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = RenderRules)
+	bool bOpaqueContent;
+
+	/**
+	 * Should the retained surface be reused while render transforms scale or rotate the retainer.  The content
+	 * is drawn at a reference scale and the surface is scaled when it's drawn, instead of redrawing every frame
+	 * a scale animation plays.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Transform)
+	bool bTransformTolerant;
+
+	/**
+	 * The render transform scale to draw the content at, or 0 to draw at the largest scale seen so far.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Transform, meta = (EditCondition = "bTransformTolerant", UIMin = 0, ClampMin = 0))
+	float TransformReferenceScale;
+
+	/**
+	 * How far, as a fraction, the scale can move away from the reference before the content is redrawn at
+	 * the actual scale.  When drawing at the largest scale seen, only growing past it counts while the scale
+	 * animates, and the content is redrawn at the largest scale once it settles.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Transform, meta = (EditCondition = "bTransformTolerant", UIMin = 0, ClampMin = 0, UIMax = 1, ClampMax = 1))
+	float TransformQualityBand;
+
+	/**
+	 * Splits large surfaces into tiles and spreads each redraw over several frames, a few tiles at a time.
+	 * The last complete surface is shown until all the tiles of the new one are drawn.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Tiling)
+	bool bTiledRedraw;
+
+	/** The width and height of the tiles in pixels. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Tiling, meta = (EditCondition = "bTiledRedraw", UIMin = 64, ClampMin = 64))
+	int32 TileSize;
+
+	/** The most tiles redrawn in a frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Tiling, meta = (EditCondition = "bTiledRedraw", UIMin = 1, ClampMin = 1))
+	int32 TilesPerFrame;
+
+	/**
+	 * How to use the surface baked for this retainer by the UIRetainerBoxBake commandlet.  Baked retainers
+	 * show the baked surface straight away, and either build their content later or never.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Baking)
+	EUIRetainerBoxBakeMode BakeMode;
+
+	/**
+	 * The name of the retainer group to join.  Every retainer box with the same group name is controlled by
+	 * the same group, which can be found with UUIRetainerGroup::FindOrCreateNamedGroup.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Group)
+	FName RetainerGroupName;
+
 public:
 
 	/**
@@ -106,6 +212,67 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Retainer|Colour Space")
 	void SetTextureParameter(FName TextureParameter);
 
+	/**
+	 * Sets whether screen size LOD is enabled and the tiers to choose from.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|LOD")
+	void SetScreenSizeLOD(bool bInEnableScreenSizeLOD, const TArray<FUIRetainerBoxLODTier>& InLODTiers);
+
+	/**
+	 * Sets the key and content version used to share the retained surface with other retainers.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Instancing")
+	void SetSurfaceKey(FName InSurfaceKey, int32 InContentVersion);
+
+	/**
+	 * Starts creating the render target at the given size in pixels ahead of time, so the first draw doesn't hitch.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Prewarm")
+	void PrewarmSurface(FVector2D Size);
+
+	/**
+	 * Prewarms the render target of every retainer box found in the widget and its children, at the size they
+	 * want to be drawn at in the viewport.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Prewarm")
+	static void PrewarmSurfacesInWidget(UWidget* RootWidget);
+
+	/**
+	 * Reads the retained surface back after its next redraw without stalling the game thread, the result
+	 * arrives a few frames later.  Under NullRHI the result holds the drawn elements instead of pixels.
+	 * If the retainer has no widget the result is empty and arrives straight away.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Readback")
+	void RequestReadback(FOnUIRetainerBoxReadback OnComplete);
+
+	/**
+	 * Gets how many invalidations from the content requested a redraw, and how many were ignored because
+	 * they couldn't change what the retainer draws.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Invalidation")
+	FUIRetainerBoxInvalidationStats GetInvalidationStats() const;
+
+	/**
+	 * Compresses the retained surface into system memory and releases its render target, for static content
+	 * that's going to be hidden for a while.  It's restored from memory when next shown, unless it's redrawn.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Eviction")
+	void EvictRetainedSurface();
+
+	/** Gets how much memory the evicted surface takes, and how long compressing and restoring it took. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Eviction")
+	FUIRetainerBoxEvictionStats GetEvictionStats() const;
+
+	/**
+	 * Moves the retainer into a group, or out of any group if null.  The group's refresh rate, pause state and
+	 * budget then apply to it.  Replaces the group named by RetainerGroupName.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void SetRetainerGroup(UUIRetainerGroup* InRetainerGroup);
+
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	UUIRetainerGroup* GetRetainerGroup() const;
+
 	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
 
 #if WITH_EDITOR
@@ -114,6 +281,9 @@ public:
 
 	const FGeometry& GetCachedAllottedGeometry() const;
 
+	/** Gets the name of the package the surface of this retainer is baked into, based on the owning user widget's class and path. */
+	FString GetBakedSurfacePackageName() const;
+
 protected:
 
 	/**
@@ -145,4 +315,17 @@ protected:
 
 protected:
 	TSharedPtr<class SUIRetainerBoxWidget> MyRetainerWidget;
+
+	UPROPERTY(Transient)
+	UUIRetainerGroup* RetainerGroup;
+
+	/** The baked surface loaded for this retainer, if any. */
+	UPROPERTY(Transient)
+	UTexture2D* BakedSurface;
+
+	/** Identifies the latest load of the baked surface, so loads for a widget since rebuilt are ignored. */
+	uint32 BakedSurfaceLoadRequest = 0;
+
+private:
+	void OnBakedSurfaceLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result, uint32 LoadRequest);
 };
\ No newline at end of file
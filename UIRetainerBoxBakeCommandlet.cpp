@@ -0,0 +1,295 @@
+#include "UIRetainerBoxBakeCommandlet.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Parse.h"
+#include "Misc/PackageName.h"
+#include "Modules/ModuleManager.h"
+#include "AssetRegistryModule.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Interfaces/ISlateRHIRendererModule.h"
+#include "Slate/WidgetRenderer.h"
+#include "Engine/World.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/WidgetTree.h"
+#include "RenderingThread.h"
+#include "UObject/Package.h"
+
+#include "UIRetainerBox.h"
+#include "SUIRetainerBoxWidget.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUIRetainerBoxBake, Log, All);
+
+struct FUIRetainerBoxBakeSettings
+{
+	FIntPoint Resolution = FIntPoint(1920, 1080);
+	float Scale = 1.f;
+};
+
+/** What a baked retainer would have cost at startup without its baked surface. */
+struct FUIRetainerBoxBakeCost
+{
+	double ContentConstructionMs = 0.0;
+
+	/** Creating the render target, the prepass and the paint of the first draw. */
+	double FirstDrawMs = 0.0;
+};
+
+#if WITH_EDITOR
+
+/** Saves the pixels as a UI texture in the given package, replacing any texture baked there before. */
+static bool SaveBakedSurface(const FString& PackageName, FIntPoint Size, const TArray<FColor>& Pixels, bool bSRGB, float BakeScale)
+{
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	Package->FullyLoad();
+
+	const FString AssetName = FPackageName::GetShortName(PackageName);
+
+	UTexture2D* Texture = FindObject<UTexture2D>(Package, *AssetName);
+	if (!Texture)
+	{
+		Texture = NewObject<UTexture2D>(Package, *AssetName, RF_Public | RF_Standalone);
+		FAssetRegistryModule::AssetCreated(Texture);
+	}
+
+	Texture->Source.Init(Size.X, Size.Y, 1, 1, TSF_BGRA8, reinterpret_cast<const uint8*>(Pixels.GetData()));
+	Texture->SRGB = bSRGB;
+	Texture->CompressionSettings = TC_EditorIcon;
+	Texture->MipGenSettings = TMGS_NoMipmaps;
+	Texture->LODGroup = TEXTUREGROUP_UI;
+	Texture->NeverStream = true;
+
+	UUIRetainerBoxBakeData* BakeData = Texture->GetAssetUserData<UUIRetainerBoxBakeData>();
+	if (!BakeData)
+	{
+		BakeData = NewObject<UUIRetainerBoxBakeData>(Texture);
+		Texture->AddAssetUserData(BakeData);
+	}
+	BakeData->BakeScale = BakeScale;
+	Texture->PostEditChange();
+
+	Package->MarkPackageDirty();
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	return UPackage::SavePackage(Package, Texture, RF_Public | RF_Standalone, *Filename);
+}
+
+/** Creates the widget, draws it off screen and bakes the surfaces of its retainers, adding what they would have cost to the total. */
+static int32 BakeWidget(UWorld* World, UClass* WidgetClass, const FUIRetainerBoxBakeSettings& Settings, FUIRetainerBoxBakeCost& OutTotalCost)
+{
+	UUserWidget* UserWidget = CreateWidget<UUserWidget>(World, WidgetClass);
+	if (!UserWidget || !UserWidget->WidgetTree)
+	{
+		UE_LOG(LogUIRetainerBoxBake, Warning, TEXT("Couldn't create widget '%s'."), *WidgetClass->GetPathName());
+		return 0;
+	}
+
+	TArray<UUIRetainerBox*> RetainerBoxes;
+	UserWidget->WidgetTree->ForEachWidget([&RetainerBoxes](UWidget* Widget)
+	{
+		UUIRetainerBox* RetainerBox = Cast<UUIRetainerBox>(Widget);
+		if (RetainerBox && RetainerBox->BakeMode != EUIRetainerBoxBakeMode::None)
+		{
+			RetainerBoxes.Add(RetainerBox);
+		}
+	});
+
+	if (RetainerBoxes.Num() == 0)
+	{
+		return 0;
+	}
+
+	// Build the content of each retainer on its own first, to time what baking lets it skip or put off.
+	TArray<FUIRetainerBoxBakeCost> Costs;
+	Costs.SetNum(RetainerBoxes.Num());
+
+	for (int32 Index = 0; Index < RetainerBoxes.Num(); Index++)
+	{
+		if (UWidget* Content = RetainerBoxes[Index]->GetContent())
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Content->TakeWidget();
+			Costs[Index].ContentConstructionMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+	}
+
+	const TSharedRef<SWidget> RootWidget = UserWidget->TakeWidget();
+
+	FWidgetRenderer WidgetRenderer(true);
+	UTextureRenderTarget2D* RootTarget = FWidgetRenderer::CreateTargetFor(FVector2D(Settings.Resolution), TF_Bilinear, true);
+
+	// The first draw of each retainer is timed to report what baking saves.
+	const bool bWasMeasuringRedrawTimings = SUIRetainerBoxWidget::Shared_MeasureRedrawTimings;
+	SUIRetainerBoxWidget::Shared_MeasureRedrawTimings = true;
+
+	GFrameCounter++;
+	WidgetRenderer.DrawWidget(RootTarget, RootWidget, Settings.Scale, FVector2D(Settings.Resolution), 0.f);
+	FlushRenderingCommands();
+
+	SUIRetainerBoxWidget::Shared_MeasureRedrawTimings = bWasMeasuringRedrawTimings;
+
+	int32 NumBaked = 0;
+
+	for (int32 Index = 0; Index < RetainerBoxes.Num(); Index++)
+	{
+		UUIRetainerBox* RetainerBox = RetainerBoxes[Index];
+		TSharedPtr<SUIRetainerBoxWidget> RetainerWidget = StaticCastSharedPtr<SUIRetainerBoxWidget>(RetainerBox->GetCachedWidget());
+		UTextureRenderTarget2D* RenderTarget = RetainerWidget.IsValid() ? RetainerWidget->GetRenderTarget() : nullptr;
+
+		if (!RenderTarget || RetainerWidget->GetRedrawCount() == 0 || RenderTarget->GetSurfaceWidth() < 1 || RenderTarget->GetSurfaceHeight() < 1)
+		{
+			UE_LOG(LogUIRetainerBoxBake, Warning, TEXT("Retainer '%s' in '%s' wasn't drawn, make sure it's visible at %dx%d."),
+				*RetainerBox->GetName(), *WidgetClass->GetName(), Settings.Resolution.X, Settings.Resolution.Y);
+			continue;
+		}
+
+		const FIntPoint Size(RenderTarget->GetSurfaceWidth(), RenderTarget->GetSurfaceHeight());
+
+		TArray<FColor> Pixels;
+		if (!RenderTarget->GameThread_GetRenderTargetResource()->ReadPixels(Pixels) || Pixels.Num() != Size.X * Size.Y)
+		{
+			UE_LOG(LogUIRetainerBoxBake, Warning, TEXT("Failed to read back retainer '%s' in '%s'."), *RetainerBox->GetName(), *WidgetClass->GetName());
+			continue;
+		}
+
+		const FString PackageName = RetainerBox->GetBakedSurfacePackageName();
+
+		if (!SaveBakedSurface(PackageName, Size, Pixels, RenderTarget->SRGB, Settings.Scale))
+		{
+			UE_LOG(LogUIRetainerBoxBake, Error, TEXT("Failed to save '%s'."), *PackageName);
+			continue;
+		}
+
+		FUIRetainerBoxBakeCost& Cost = Costs[Index];
+		Cost.FirstDrawMs = RetainerWidget->GetLastSurfaceCreationMs() + RetainerWidget->GetLastPrepassMs() + RetainerWidget->GetLastPaintMs();
+
+		UE_LOG(LogUIRetainerBoxBake, Display, TEXT("  %s (%dx%d, %s): content construction %.2fms, first draw %.2fms"),
+			*PackageName, Size.X, Size.Y,
+			RetainerBox->BakeMode == EUIRetainerBoxBakeMode::Frozen ? TEXT("frozen") : TEXT("lazy"),
+			Cost.ContentConstructionMs, Cost.FirstDrawMs);
+
+		OutTotalCost.ContentConstructionMs += Cost.ContentConstructionMs;
+		OutTotalCost.FirstDrawMs += Cost.FirstDrawMs;
+		NumBaked++;
+	}
+
+	UserWidget->ReleaseSlateResources(true);
+
+	return NumBaked;
+}
+
+#endif
+
+UUIRetainerBoxBakeCommandlet::UUIRetainerBoxBakeCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UUIRetainerBoxBakeCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	if (GUsingNullRHI)
+	{
+		UE_LOG(LogUIRetainerBoxBake, Error, TEXT("Baking retainer surfaces needs a renderer, run with -AllowCommandletRendering."));
+		return 1;
+	}
+
+	FUIRetainerBoxBakeSettings Settings;
+	FString ResolutionParam;
+	if (FParse::Value(*Params, TEXT("Resolution="), ResolutionParam))
+	{
+		FString Width, Height;
+		if (ResolutionParam.Split(TEXT("x"), &Width, &Height))
+		{
+			Settings.Resolution = FIntPoint(FCString::Atoi(*Width), FCString::Atoi(*Height));
+		}
+	}
+	FParse::Value(*Params, TEXT("Scale="), Settings.Scale);
+
+	if (Settings.Resolution.X < 1 || Settings.Resolution.Y < 1 || Settings.Scale <= 0.f)
+	{
+		UE_LOG(LogUIRetainerBoxBake, Error, TEXT("Invalid resolution or scale."));
+		return 1;
+	}
+
+	// Find the generated classes of the widget blueprints to bake.
+	TArray<FString> WidgetClassPaths;
+	FString WidgetsParam;
+	if (FParse::Value(*Params, TEXT("Widgets="), WidgetsParam, false))
+	{
+		TArray<FString> WidgetPaths;
+		WidgetsParam.ParseIntoArray(WidgetPaths, TEXT(","));
+
+		for (const FString& WidgetPath : WidgetPaths)
+		{
+			WidgetClassPaths.Add(FString::Printf(TEXT("%s.%s_C"), *WidgetPath, *FPackageName::GetShortName(WidgetPath)));
+		}
+	}
+	else
+	{
+		FString SearchPath = TEXT("/Game");
+		FParse::Value(*Params, TEXT("Path="), SearchPath);
+
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+		AssetRegistry.SearchAllAssets(true);
+
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByPath(FName(*SearchPath), Assets, true);
+
+		for (const FAssetData& Asset : Assets)
+		{
+			if (Asset.AssetClass == TEXT("WidgetBlueprint"))
+			{
+				WidgetClassPaths.Add(Asset.ObjectPath.ToString() + TEXT("_C"));
+			}
+		}
+	}
+
+	if (!FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Create();
+
+		TSharedRef<FSlateRenderer> SlateRenderer = FModuleManager::Get().LoadModuleChecked<ISlateRHIRendererModule>("SlateRHIRenderer").CreateSlateRHIRenderer();
+		FSlateApplication::Get().InitializeRenderer(SlateRenderer);
+	}
+
+	// Retainers have to draw their content to be baked, not show what was baked before.
+	IConsoleVariable* UseBakedSurfaces = IConsoleManager::Get().FindConsoleVariable(TEXT("Slate.UseBakedUIRetainerSurfaces"));
+	const int32 PreviousUseBakedSurfaces = UseBakedSurfaces->GetInt();
+	UseBakedSurfaces->Set(0);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::GamePreview, false);
+
+	FUIRetainerBoxBakeCost TotalCost;
+	int32 NumBaked = 0;
+
+	for (const FString& WidgetClassPath : WidgetClassPaths)
+	{
+		UClass* WidgetClass = LoadObject<UClass>(nullptr, *WidgetClassPath);
+		if (!WidgetClass || !WidgetClass->IsChildOf(UUserWidget::StaticClass()))
+		{
+			UE_LOG(LogUIRetainerBoxBake, Warning, TEXT("'%s' isn't a widget class, skipping."), *WidgetClassPath);
+			continue;
+		}
+
+		NumBaked += BakeWidget(World, WidgetClass, Settings, TotalCost);
+	}
+
+	World->DestroyWorld(false);
+	UseBakedSurfaces->Set(PreviousUseBakedSurfaces);
+
+	UE_LOG(LogUIRetainerBoxBake, Display, TEXT("Baked %d retainer surfaces from %d widgets."), NumBaked, WidgetClassPaths.Num());
+	UE_LOG(LogUIRetainerBoxBake, Display, TEXT("Estimated startup time saved: %.2fms (%.2fms of content construction put off or skipped, %.2fms of first draws skipped)."),
+		TotalCost.ContentConstructionMs + TotalCost.FirstDrawMs, TotalCost.ContentConstructionMs, TotalCost.FirstDrawMs);
+
+	return 0;
+#else
+	UE_LOG(LogUIRetainerBoxBake, Error, TEXT("Baking retainer surfaces is only supported in editor builds."));
+	return 1;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "UIRetainerBoxBakeCommandlet.generated.h"
+
+/**
+ * Renders every retainer box with a bake mode set to a texture asset, so it can be shown at startup without
+ * building or drawing its content.  Widgets are laid out and drawn off screen, so this runs on build machines
+ * without a window, but it does need a renderer.
+ *
+ * Run with -AllowCommandletRendering, e.g.
+ *   UE4Editor-Cmd <Project> -run=UIRetainerBoxBake -AllowCommandletRendering -Path=/Game/UI
+ *
+ * Parameters
+ *   -Path=         Content path to search for widget blueprints (default /Game)
+ *   -Widgets=      Comma separated list of widget blueprints to bake instead of searching
+ *   -Resolution=   Size in pixels the widgets are laid out at (default 1920x1080)
+ *   -Scale=        DPI scale the widgets are laid out at (default 1)
+ *
+ * The baked textures are saved under /Game/BakedUIRetainers along with the scale they were baked at, which
+ * needs adding to the directories to always cook.
+ */
+UCLASS()
+class UUIRetainerBoxBakeCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet
+};
\ No newline at end of file
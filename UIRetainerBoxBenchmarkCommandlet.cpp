@@ -0,0 +1,552 @@
+#include "UIRetainerBoxBenchmarkCommandlet.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/AutomationTest.h"
+#include "Modules/ModuleManager.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Interfaces/ISlateNullRendererModule.h"
+#include "Input/HittestGrid.h"
+#include "Widgets/SVirtualWindow.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SUniformGridPanel.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Engine/TextureRenderTarget2D.h"
+
+#include "SUIRetainerBoxWidget.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUIRetainerBoxBenchmark, Log, All);
+
+/**
+ * Counts the game thread's allocations while counting, passing everything through to the real allocator.  It's only
+ * installed over GMalloc while counting, and other threads allocating through it meanwhile aren't counted.
+ */
+class FUIRetainerBoxCountingMalloc : public FMalloc
+{
+public:
+	/**
+	 * The counting allocator, wrapping the GMalloc of its first use.  It's never deleted, as other threads may
+	 * still be inside a call through it after it has been uninstalled.
+	 */
+	static FUIRetainerBoxCountingMalloc& Get()
+	{
+		static FUIRetainerBoxCountingMalloc* Instance = new FUIRetainerBoxCountingMalloc(GMalloc);
+		return *Instance;
+	}
+
+	/** Installs the allocator over GMalloc and starts counting. */
+	void BeginCounting()
+	{
+		check(FPlatformTLS::GetCurrentThreadId() == OwnerThreadId);
+		check(GMalloc == InnerMalloc);
+
+		AllocationCount = 0;
+		bCounting = true;
+
+		FPlatformMisc::MemoryBarrier();
+		GMalloc = this;
+	}
+
+	/** Puts the real allocator back and returns how many allocations were counted. */
+	int64 EndCounting()
+	{
+		check(FPlatformTLS::GetCurrentThreadId() == OwnerThreadId);
+
+		GMalloc = InnerMalloc;
+		FPlatformMisc::MemoryBarrier();
+
+		bCounting = false;
+		return AllocationCount;
+	}
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->Malloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation();
+		return InnerMalloc->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override
+	{
+		InnerMalloc->Free(Original);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+	{
+		return InnerMalloc->QuantizeSize(Count, Alignment);
+	}
+
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+	{
+		return InnerMalloc->GetAllocationSize(Original, SizeOut);
+	}
+
+	virtual void Trim() override
+	{
+		InnerMalloc->Trim();
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return InnerMalloc->IsInternallyThreadSafe();
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return TEXT("UIRetainerBoxCountingMalloc");
+	}
+
+private:
+	FUIRetainerBoxCountingMalloc(FMalloc* InInnerMalloc)
+		: InnerMalloc(InInnerMalloc)
+		, OwnerThreadId(FPlatformTLS::GetCurrentThreadId())
+		, bCounting(false)
+		, AllocationCount(0)
+	{}
+
+	void CountAllocation()
+	{
+		// The thread id is checked first, so the counting state is only ever touched by the owning thread.
+		if (FPlatformTLS::GetCurrentThreadId() == OwnerThreadId && bCounting)
+		{
+			AllocationCount++;
+		}
+	}
+
+	FMalloc* InnerMalloc;
+	const uint32 OwnerThreadId;
+	bool bCounting;
+	int64 AllocationCount;
+};
+
+enum class EUIRetainerBoxBenchmarkScenario : uint8
+{
+	/** Retainers redraw on spread out phases. */
+	Phase,
+	/** Retainers only redraw when a hosted widget invalidates, a few of them every frame. */
+	Invalidation,
+	/** The host window is resized every few frames, forcing every retainer to resize its target. */
+	Resize,
+	/** Every few frames all widgets are globally invalidated. */
+	GlobalInvalidate
+};
+
+static const TCHAR* GetScenarioName(EUIRetainerBoxBenchmarkScenario Scenario)
+{
+	switch (Scenario)
+	{
+	case EUIRetainerBoxBenchmarkScenario::Phase: return TEXT("Phase");
+	case EUIRetainerBoxBenchmarkScenario::Invalidation: return TEXT("Invalidation");
+	case EUIRetainerBoxBenchmarkScenario::Resize: return TEXT("Resize");
+	case EUIRetainerBoxBenchmarkScenario::GlobalInvalidate: return TEXT("GlobalInvalidate");
+	}
+
+	return TEXT("Unknown");
+}
+
+struct FUIRetainerBoxBenchmarkSettings
+{
+	int32 NumRetainers = 16;
+	int32 NumChildren = 32;
+	int32 NumFrames = 2000;
+	int32 NumWarmupFrames = 60;
+};
+
+/** Phase count of the retainers in the phase scenario, which spreads them over this many frames. */
+static const int32 BenchmarkPhaseCount = 4;
+
+struct FUIRetainerBoxBenchmarkResult
+{
+	EUIRetainerBoxBenchmarkScenario Scenario;
+	TArray<double> FrameTimesMs;
+	int32 Redraws = 0;
+	int32 Invalidations = 0;
+	int64 Allocations = 0;
+	int64 PeakRenderTargetBytes = 0;
+};
+
+/** A synthetic widget tree hosted under a number of retainers, painted into a virtual window once per frame. */
+class FUIRetainerBoxBenchmarkScene
+{
+public:
+	FUIRetainerBoxBenchmarkScene(const FUIRetainerBoxBenchmarkSettings& Settings, EUIRetainerBoxBenchmarkScenario InScenario)
+		: Scenario(InScenario)
+		, WindowSize(1920.f, 1080.f)
+	{
+		const bool bRenderOnPhase = Scenario != EUIRetainerBoxBenchmarkScenario::Invalidation;
+		const int32 PhaseCount = Scenario == EUIRetainerBoxBenchmarkScenario::Phase ? BenchmarkPhaseCount : 1;
+		const int32 NumColumns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Settings.NumRetainers))));
+
+		TSharedRef<SUniformGridPanel> Grid = SNew(SUniformGridPanel);
+
+		for (int32 RetainerIndex = 0; RetainerIndex < Settings.NumRetainers; RetainerIndex++)
+		{
+			TSharedRef<SVerticalBox> Content = SNew(SVerticalBox);
+
+			for (int32 ChildIndex = 0; ChildIndex < Settings.NumChildren; ChildIndex++)
+			{
+				TSharedRef<STextBlock> TextBlock = SNew(STextBlock)
+					.Text(FText::AsNumber(ChildIndex));
+
+				Content->AddSlot()
+				.AutoHeight()
+				[
+					SNew(SBorder)
+					[
+						TextBlock
+					]
+				];
+
+				TextBlocks.Add(TextBlock);
+			}
+
+			TSharedRef<SUIRetainerBoxWidget> Retainer = SNew(SUIRetainerBoxWidget)
+				.RenderOnPhase(bRenderOnPhase)
+				.RenderOnInvalidation(!bRenderOnPhase)
+				.Phase(RetainerIndex % PhaseCount)
+				.PhaseCount(PhaseCount)
+				[
+					Content
+				];
+
+			Retainer->SetRetainedRendering(true);
+
+			Grid->AddSlot(RetainerIndex % NumColumns, RetainerIndex / NumColumns)
+			[
+				Retainer
+			];
+
+			Retainers.Add(Retainer);
+		}
+
+		Window = SNew(SVirtualWindow).Size(WindowSize);
+		Window->SetContent(Grid);
+	}
+
+	/** Applies the scenario's changes for the frame and paints the window, returning how long that took in milliseconds. */
+	double RunFrame(int32 FrameIndex)
+	{
+		GFrameCounter++;
+		FApp::SetCurrentTime(FApp::GetCurrentTime() + FrameDeltaTime);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		switch (Scenario)
+		{
+		case EUIRetainerBoxBenchmarkScenario::Invalidation:
+		{
+			// Touch a handful of widgets spread across the retainers each frame.
+			for (int32 Index = FrameIndex % 7; Index < TextBlocks.Num(); Index += 7 * Retainers.Num())
+			{
+				TextBlocks[Index]->SetText(FText::AsNumber(FrameIndex));
+				TextBlocks[Index]->Invalidate(EInvalidateWidget::Layout);
+				Invalidations++;
+			}
+			break;
+		}
+		case EUIRetainerBoxBenchmarkScenario::Resize:
+		{
+			if (FrameIndex % 10 == 0)
+			{
+				const float Scale = 0.75f + 0.25f * ((FrameIndex / 10) % 3);
+				WindowSize = FVector2D(1920.f, 1080.f) * Scale;
+			}
+			break;
+		}
+		case EUIRetainerBoxBenchmarkScenario::GlobalInvalidate:
+		{
+			if (FrameIndex % 30 == 0)
+			{
+				FSlateApplication::Get().InvalidateAllWidgets();
+			}
+			break;
+		}
+		case EUIRetainerBoxBenchmarkScenario::Phase:
+		default:
+			break;
+		}
+
+		const FGeometry WindowGeometry = FGeometry::MakeRoot(WindowSize, FSlateLayoutTransform());
+		const FSlateRect WindowClipRect = WindowGeometry.GetLayoutBoundingRect();
+
+		Window->SlatePrepass(1.f);
+
+		FHittestGrid HittestGrid;
+		HittestGrid.ClearGridForNewFrame(WindowClipRect);
+
+		FSlateWindowElementList ElementList(Window);
+		FPaintArgs PaintArgs(*Window, HittestGrid, FVector2D::ZeroVector, FApp::GetCurrentTime(), FrameDeltaTime);
+
+		Window->Paint(PaintArgs, WindowGeometry, WindowClipRect, ElementList, 0, FWidgetStyle(), true);
+
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+
+	int32 GetRedrawCount() const
+	{
+		int32 Redraws = 0;
+		for (const TSharedRef<SUIRetainerBoxWidget>& Retainer : Retainers)
+		{
+			Redraws += Retainer->GetRedrawCount();
+		}
+		return Redraws;
+	}
+
+	/** How many hosted widgets the invalidation scenario has invalidated so far. */
+	int32 GetInvalidationCount() const
+	{
+		return Invalidations;
+	}
+
+	int64 GetRenderTargetBytes() const
+	{
+		int64 Bytes = 0;
+		for (const TSharedRef<SUIRetainerBoxWidget>& Retainer : Retainers)
+		{
+			if (UTextureRenderTarget2D* RenderTarget = Retainer->GetRenderTarget())
+			{
+				// Retainers always draw into PF_B8G8R8A8 targets.
+				Bytes += static_cast<int64>(RenderTarget->GetSurfaceWidth()) * RenderTarget->GetSurfaceHeight() * 4;
+			}
+		}
+		return Bytes;
+	}
+
+private:
+	static constexpr float FrameDeltaTime = 1.f / 60.f;
+
+	EUIRetainerBoxBenchmarkScenario Scenario;
+	FVector2D WindowSize;
+	int32 Invalidations = 0;
+
+	TSharedPtr<SVirtualWindow> Window;
+	TArray<TSharedRef<SUIRetainerBoxWidget>> Retainers;
+	TArray<TSharedRef<STextBlock>> TextBlocks;
+};
+
+static double GetPercentile(const TArray<double>& SortedValues, double Percentile)
+{
+	if (SortedValues.Num() == 0)
+	{
+		return 0.0;
+	}
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * SortedValues.Num()) - 1, 0, SortedValues.Num() - 1);
+	return SortedValues[Index];
+}
+
+static FUIRetainerBoxBenchmarkResult RunScenario(const FUIRetainerBoxBenchmarkSettings& Settings, EUIRetainerBoxBenchmarkScenario Scenario)
+{
+	FUIRetainerBoxBenchmarkResult Result;
+	Result.Scenario = Scenario;
+	Result.FrameTimesMs.Reserve(Settings.NumFrames);
+
+	// The scene advances the application time every frame, put it back once the run is over.
+	const double StartCurrentTime = FApp::GetCurrentTime();
+
+	FUIRetainerBoxBenchmarkScene Scene(Settings, Scenario);
+
+	for (int32 FrameIndex = 0; FrameIndex < Settings.NumWarmupFrames; FrameIndex++)
+	{
+		Scene.RunFrame(FrameIndex);
+	}
+
+	const int32 RedrawsBefore = Scene.GetRedrawCount();
+	const int32 InvalidationsBefore = Scene.GetInvalidationCount();
+
+	FUIRetainerBoxCountingMalloc& CountingMalloc = FUIRetainerBoxCountingMalloc::Get();
+	CountingMalloc.BeginCounting();
+
+	for (int32 FrameIndex = 0; FrameIndex < Settings.NumFrames; FrameIndex++)
+	{
+		Result.FrameTimesMs.Add(Scene.RunFrame(Settings.NumWarmupFrames + FrameIndex));
+		Result.PeakRenderTargetBytes = FMath::Max(Result.PeakRenderTargetBytes, Scene.GetRenderTargetBytes());
+	}
+
+	Result.Allocations = CountingMalloc.EndCounting();
+	Result.Redraws = Scene.GetRedrawCount() - RedrawsBefore;
+	Result.Invalidations = Scene.GetInvalidationCount() - InvalidationsBefore;
+
+	FApp::SetCurrentTime(StartCurrentTime);
+
+	return Result;
+}
+
+static const TCHAR* BenchmarkCsvHeader = TEXT("Build,Scenario,Retainers,ChildrenPerRetainer,Frames,MeanMs,P50Ms,P90Ms,P99Ms,MaxMs,Redraws,RedrawsPerFrame,Allocations,AllocationsPerFrame,PeakRenderTargetBytes\n");
+
+/** Logs the result's frame time percentiles and counts, and returns them as a row of the CSV. */
+static FString ReportResult(const FUIRetainerBoxBenchmarkSettings& Settings, const FUIRetainerBoxBenchmarkResult& Result)
+{
+	double TotalMs = 0.0;
+	for (double FrameTimeMs : Result.FrameTimesMs)
+	{
+		TotalMs += FrameTimeMs;
+	}
+
+	TArray<double> SortedFrameTimesMs = Result.FrameTimesMs;
+	SortedFrameTimesMs.Sort();
+
+	const double MeanMs = TotalMs / Result.FrameTimesMs.Num();
+	const double P50Ms = GetPercentile(SortedFrameTimesMs, 0.5);
+	const double P90Ms = GetPercentile(SortedFrameTimesMs, 0.9);
+	const double P99Ms = GetPercentile(SortedFrameTimesMs, 0.99);
+	const double MaxMs = SortedFrameTimesMs.Last();
+
+	UE_LOG(LogUIRetainerBoxBenchmark, Display, TEXT("  mean %.3fms, p50 %.3fms, p90 %.3fms, p99 %.3fms, max %.3fms, %d redraws, %lld allocations, %lld render target bytes"),
+		MeanMs, P50Ms, P90Ms, P99Ms, MaxMs, Result.Redraws, Result.Allocations, Result.PeakRenderTargetBytes);
+
+	return FString::Printf(TEXT("%s,%s,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%.3f,%lld,%.1f,%lld\n"),
+		FApp::GetBuildVersion(),
+		GetScenarioName(Result.Scenario),
+		Settings.NumRetainers,
+		Settings.NumChildren,
+		Settings.NumFrames,
+		MeanMs, P50Ms, P90Ms, P99Ms, MaxMs,
+		Result.Redraws,
+		static_cast<double>(Result.Redraws) / Settings.NumFrames,
+		Result.Allocations,
+		static_cast<double>(Result.Allocations) / Settings.NumFrames,
+		Result.PeakRenderTargetBytes);
+}
+
+UUIRetainerBoxBenchmarkCommandlet::UUIRetainerBoxBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UUIRetainerBoxBenchmarkCommandlet::Main(const FString& Params)
+{
+	FUIRetainerBoxBenchmarkSettings Settings;
+	FParse::Value(*Params, TEXT("Retainers="), Settings.NumRetainers);
+	FParse::Value(*Params, TEXT("Children="), Settings.NumChildren);
+	FParse::Value(*Params, TEXT("Frames="), Settings.NumFrames);
+	FParse::Value(*Params, TEXT("Warmup="), Settings.NumWarmupFrames);
+
+	Settings.NumRetainers = FMath::Max(Settings.NumRetainers, 1);
+	Settings.NumChildren = FMath::Max(Settings.NumChildren, 1);
+	Settings.NumFrames = FMath::Max(Settings.NumFrames, 1);
+	Settings.NumWarmupFrames = FMath::Max(Settings.NumWarmupFrames, 0);
+
+	TArray<EUIRetainerBoxBenchmarkScenario> Scenarios;
+	FString ScenariosParam;
+	if (FParse::Value(*Params, TEXT("Scenarios="), ScenariosParam, false))
+	{
+		TArray<FString> ScenarioNames;
+		ScenariosParam.ParseIntoArray(ScenarioNames, TEXT(","));
+
+		for (const FString& ScenarioName : ScenarioNames)
+		{
+			bool bFound = false;
+			for (EUIRetainerBoxBenchmarkScenario Scenario : { EUIRetainerBoxBenchmarkScenario::Phase, EUIRetainerBoxBenchmarkScenario::Invalidation, EUIRetainerBoxBenchmarkScenario::Resize, EUIRetainerBoxBenchmarkScenario::GlobalInvalidate })
+			{
+				if (ScenarioName.Equals(GetScenarioName(Scenario), ESearchCase::IgnoreCase))
+				{
+					Scenarios.Add(Scenario);
+					bFound = true;
+				}
+			}
+
+			if (!bFound)
+			{
+				UE_LOG(LogUIRetainerBoxBenchmark, Error, TEXT("Unknown scenario '%s'."), *ScenarioName);
+				return 1;
+			}
+		}
+	}
+	else
+	{
+		Scenarios = { EUIRetainerBoxBenchmarkScenario::Phase, EUIRetainerBoxBenchmarkScenario::Invalidation, EUIRetainerBoxBenchmarkScenario::Resize, EUIRetainerBoxBenchmarkScenario::GlobalInvalidate };
+	}
+
+	FString OutputPath = FPaths::ProfilingDir() / TEXT("UIRetainerBoxBenchmark.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	if (!FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Create();
+
+		TSharedRef<FSlateRenderer> SlateRenderer = FModuleManager::Get().LoadModuleChecked<ISlateNullRendererModule>("SlateNullRenderer").CreateSlateNullRenderer();
+		FSlateApplication::Get().InitializeRenderer(SlateRenderer);
+	}
+
+	FString Csv = BenchmarkCsvHeader;
+
+	for (EUIRetainerBoxBenchmarkScenario Scenario : Scenarios)
+	{
+		UE_LOG(LogUIRetainerBoxBenchmark, Display, TEXT("Running scenario %s with %d retainers of %d widgets for %d frames..."), GetScenarioName(Scenario), Settings.NumRetainers, Settings.NumChildren, Settings.NumFrames);
+
+		Csv += ReportResult(Settings, RunScenario(Settings, Scenario));
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogUIRetainerBoxBenchmark, Error, TEXT("Failed to write results to '%s'."), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogUIRetainerBoxBenchmark, Display, TEXT("Results written to '%s'."), *OutputPath);
+	return 0;
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Never in the editor, the benchmark swaps GMalloc and steps the frame counter, which a running editor shouldn't see.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUIRetainerBoxBenchmarkTest, "UI.RetainerBox.Benchmark", EAutomationTestFlags::ClientContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::PerfFilter)
+
+bool FUIRetainerBoxBenchmarkTest::RunTest(const FString& Parameters)
+{
+	if (FApp::CanEverRender())
+	{
+		AddError(TEXT("The benchmark only runs headless, run it with -nullrhi."));
+		return false;
+	}
+
+	// A shorter run than the commandlet's default, so the suite stays quick.  A multiple of the phase count, so
+	// every retainer gets the same number of phases.
+	FUIRetainerBoxBenchmarkSettings Settings;
+	Settings.NumFrames = 500;
+
+	FString Csv = BenchmarkCsvHeader;
+
+	for (EUIRetainerBoxBenchmarkScenario Scenario : { EUIRetainerBoxBenchmarkScenario::Phase, EUIRetainerBoxBenchmarkScenario::Invalidation, EUIRetainerBoxBenchmarkScenario::Resize, EUIRetainerBoxBenchmarkScenario::GlobalInvalidate })
+	{
+		const FUIRetainerBoxBenchmarkResult Result = RunScenario(Settings, Scenario);
+
+		TestTrue(FString::Printf(TEXT("%s redrew its retainers"), GetScenarioName(Scenario)), Result.Redraws > 0);
+
+		if (Scenario == EUIRetainerBoxBenchmarkScenario::Phase)
+		{
+			// Nothing else asks them to redraw, so each retainer redraws exactly once per phase.
+			TestEqual(TEXT("Phase redrew every retainer once per phase"), Result.Redraws, Settings.NumRetainers * Settings.NumFrames / BenchmarkPhaseCount);
+		}
+		else if (Scenario == EUIRetainerBoxBenchmarkScenario::Invalidation)
+		{
+			// Retainers whose content wasn't invalidated are skipped, so there can't be more redraws than invalidations.
+			TestTrue(TEXT("Invalidation only redrew invalidated retainers"), Result.Redraws <= Result.Invalidations);
+		}
+
+		Csv += ReportResult(Settings, Result);
+	}
+
+	const FString OutputPath = FPaths::ProfilingDir() / TEXT("UIRetainerBoxBenchmarkTest.csv");
+	TestTrue(TEXT("Results written"), FFileHelper::SaveStringToFile(Csv, *OutputPath));
+	AddInfo(FString::Printf(TEXT("Results written to '%s'."), *OutputPath));
+
+	return true;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "UIRetainerBoxBenchmarkCommandlet.generated.h"
+
+/**
+ * Benchmarks retainer boxes headlessly by driving synthetic widget trees through a number of scenarios
+ * and writing the per-frame results to a CSV that can be compared between builds.
+ *
+ * Run with -nullrhi, e.g.
+ *   UE4Editor-Cmd <Project> -run=UIRetainerBoxBenchmark -nullrhi -Retainers=32 -Children=64 -Frames=5000
+ *
+ * Parameters
+ *   -Retainers=    Number of retainers to create (default 16)
+ *   -Children=     Number of widgets hosted under each retainer (default 32)
+ *   -Frames=       Number of measured frames per scenario (default 2000)
+ *   -Warmup=       Number of unmeasured frames run before each scenario (default 60)
+ *   -Scenarios=    Comma separated list of Phase, Invalidation, Resize, GlobalInvalidate (default all)
+ *   -Output=       Path of the CSV to write (default Saved/Profiling/UIRetainerBoxBenchmark.csv)
+ *
+ * A shorter run of every scenario is also available as the UI.RetainerBox.Benchmark automation test.  It only runs
+ * headless outside of the editor, e.g.
+ *   UE4Editor-Cmd <Project> -game -nullrhi -ExecCmds="Automation RunTests UI.RetainerBox.Benchmark;Quit"
+ */
+UCLASS()
+class UUIRetainerBoxBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet
+};
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "UIRetainerBoxReadback.h"
+#include "Containers/Ticker.h"
+#include "RenderingThread.h"
+#include "RenderCommandFence.h"
+#include "RHICommandList.h"
+#include "TextureResource.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Rendering/DrawElements.h"
+
+/** The state of a single readback, shared between the game thread ticker and the rendering thread. */
+struct FUIRetainerBoxReadbackState
+{
+	enum class EStage
+	{
+		WaitingForDraw,
+		Copying,
+		Mapping,
+		Complete
+	};
+
+	FUIRetainerBoxReadbackState()
+		: DrawnFrame(0)
+		, Stage(EStage::WaitingForDraw)
+	{}
+
+	TWeakObjectPtr<UTextureRenderTarget2D> RenderTarget;
+	uint64 DrawnFrame;
+	EStage Stage;
+
+	FRenderCommandFence Fence;
+
+	/** Only touched on the rendering thread. */
+	FTexture2DRHIRef StagingTexture;
+
+	/** Written on the rendering thread while mapping, only read on the game thread once the fence completes. */
+	FUIRetainerBoxReadbackResult Result;
+
+	FOnUIRetainerBoxReadbackComplete OnComplete;
+};
+
+typedef TSharedRef<FUIRetainerBoxReadbackState, ESPMode::ThreadSafe> FUIRetainerBoxReadbackStateRef;
+
+static bool TickReadback(float DeltaTime, FUIRetainerBoxReadbackStateRef State)
+{
+	switch (State->Stage)
+	{
+	case FUIRetainerBoxReadbackState::EStage::WaitingForDraw:
+	{
+		// Deferred retainer updates only reach the rendering thread at the end of the frame they were drawn on.
+		if (GFrameCounter <= State->DrawnFrame)
+		{
+			return true;
+		}
+
+		UTextureRenderTarget2D* RenderTarget = State->RenderTarget.Get();
+		FTextureRenderTargetResource* RenderTargetResource = RenderTarget ? RenderTarget->GameThread_GetRenderTargetResource() : nullptr;
+
+		if (!RenderTargetResource || RenderTarget->GetSurfaceWidth() < 1 || RenderTarget->GetSurfaceHeight() < 1)
+		{
+			State->Stage = FUIRetainerBoxReadbackState::EStage::Complete;
+			return true;
+		}
+
+		const FIntPoint Size(RenderTarget->GetSurfaceWidth(), RenderTarget->GetSurfaceHeight());
+		State->Result.Size = Size;
+
+		ENQUEUE_RENDER_COMMAND(UIRetainerBoxReadbackCopy)(
+			[State, RenderTargetResource, Size](FRHICommandListImmediate& RHICmdList)
+			{
+				FRHIResourceCreateInfo CreateInfo;
+				State->StagingTexture = RHICreateTexture2D(Size.X, Size.Y, PF_B8G8R8A8, 1, 1, TexCreate_CPUReadback, CreateInfo);
+
+				RHICmdList.CopyToResolveTarget(RenderTargetResource->GetRenderTargetTexture(), State->StagingTexture, FResolveParams());
+			});
+
+		State->Fence.BeginFence();
+		State->Stage = FUIRetainerBoxReadbackState::EStage::Copying;
+		return true;
+	}
+	case FUIRetainerBoxReadbackState::EStage::Copying:
+	{
+		if (!State->Fence.IsFenceComplete())
+		{
+			return true;
+		}
+
+		ENQUEUE_RENDER_COMMAND(UIRetainerBoxReadbackMap)(
+			[State](FRHICommandListImmediate& RHICmdList)
+			{
+				void* Data = nullptr;
+				int32 RowPitch = 0;
+				int32 MappedHeight = 0;
+				RHICmdList.MapStagingSurface(State->StagingTexture, Data, RowPitch, MappedHeight);
+
+				if (Data)
+				{
+					const FIntPoint Size = State->Result.Size;
+					const FColor* SourcePixels = static_cast<const FColor*>(Data);
+
+					State->Result.Pixels.SetNumUninitialized(Size.X * Size.Y);
+					for (int32 Row = 0; Row < Size.Y; Row++)
+					{
+						FMemory::Memcpy(&State->Result.Pixels[Row * Size.X], SourcePixels + Row * RowPitch, Size.X * sizeof(FColor));
+					}
+				}
+
+				RHICmdList.UnmapStagingSurface(State->StagingTexture);
+				State->StagingTexture.SafeRelease();
+			});
+
+		State->Fence.BeginFence();
+		State->Stage = FUIRetainerBoxReadbackState::EStage::Mapping;
+		return true;
+	}
+	case FUIRetainerBoxReadbackState::EStage::Mapping:
+	{
+		if (!State->Fence.IsFenceComplete())
+		{
+			return true;
+		}
+
+		State->Stage = FUIRetainerBoxReadbackState::EStage::Complete;
+		return true;
+	}
+	case FUIRetainerBoxReadbackState::EStage::Complete:
+	default:
+		break;
+	}
+
+	State->OnComplete.ExecuteIfBound(State->Result);
+	return false;
+}
+
+void FUIRetainerBoxReadback::ReadPixels(UTextureRenderTarget2D* RenderTarget, uint64 DrawnFrame, const FOnUIRetainerBoxReadbackComplete& OnComplete)
+{
+	FUIRetainerBoxReadbackStateRef State = MakeShared<FUIRetainerBoxReadbackState, ESPMode::ThreadSafe>();
+	State->RenderTarget = RenderTarget;
+	State->DrawnFrame = DrawnFrame;
+	State->OnComplete = OnComplete;
+
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickReadback, State));
+}
+
+void FUIRetainerBoxReadback::ReadElements(const FSlateWindowElementList& ElementList, const FVector2D& ViewOffset, const FIntPoint& Size, const FOnUIRetainerBoxReadbackComplete& OnComplete)
+{
+	FUIRetainerBoxReadbackStateRef State = MakeShared<FUIRetainerBoxReadbackState, ESPMode::ThreadSafe>();
+	State->Stage = FUIRetainerBoxReadbackState::EStage::Complete;
+	State->OnComplete = OnComplete;
+
+	State->Result.bHeadless = true;
+	State->Result.Size = Size;
+
+	const TArray<FSlateDrawElement>& DrawElements = ElementList.GetDrawElements();
+	State->Result.Elements.Reserve(DrawElements.Num());
+
+	for (const FSlateDrawElement& DrawElement : DrawElements)
+	{
+		FUIRetainerBoxCapturedElement& CapturedElement = State->Result.Elements.AddDefaulted_GetRef();
+		CapturedElement.ElementType = static_cast<int32>(DrawElement.GetElementType());
+		CapturedElement.Layer = DrawElement.GetLayer();
+		CapturedElement.Position = DrawElement.GetPosition() - ViewOffset;
+		CapturedElement.Size = DrawElement.GetLocalSize() * DrawElement.GetScale();
+	}
+
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickReadback, State));
+}
\ No newline at end of file
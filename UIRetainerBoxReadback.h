@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UIRetainerBoxTypes.h"
+
+class FSlateWindowElementList;
+class UTextureRenderTarget2D;
+
+/** Every readback has a result of its own, which the callback is free to move the pixels out of. */
+DECLARE_DELEGATE_OneParam(FOnUIRetainerBoxReadbackComplete, FUIRetainerBoxReadbackResult&);
+
+/**
+ * Reads retained surfaces back to the CPU without stalling the game thread.  The copy to a staging texture and
+ * the map of it are queued on the rendering thread one after the other and polled from the core ticker, so the
+ * result is delivered on the game thread a few frames after it is requested.
+ */
+class UI_API FUIRetainerBoxReadback
+{
+public:
+	/**
+	 * Reads back the pixels of the render target once the draw queued on the given frame has reached the rendering thread.
+	 */
+	static void ReadPixels(UTextureRenderTarget2D* RenderTarget, uint64 DrawnFrame, const FOnUIRetainerBoxReadbackComplete& OnComplete);
+
+	/**
+	 * Captures the elements of a headless draw, for when there is no renderer to read pixels back from.
+	 * The result is still delivered on the next tick so callers always see the same ordering.
+	 */
+	static void ReadElements(const FSlateWindowElementList& ElementList, const FVector2D& ViewOffset, const FIntPoint& Size, const FOnUIRetainerBoxReadbackComplete& OnComplete);
+};
\ No newline at end of file
@@ -1,9 +1,180 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "UIRetainerBoxTypes.generated.h"
 
 UENUM(BlueprintType)
 enum class EUIRetainerBoxColourSpace : uint8
 {
 	Linear,
 	sRGB
+};
+
+/** How a retainer box uses a surface baked for it ahead of time. */
+UENUM(BlueprintType)
+enum class EUIRetainerBoxBakeMode : uint8
+{
+	/** Not baked, the content is built and drawn as normal. */
+	None,
+	/** The baked surface is shown until the content has been built and drawn for the first time. */
+	Lazy,
+	/** Only the baked surface is ever shown, the content is never built or drawn. */
+	Frozen
+};
+
+/**
+ * A single level of detail tier for a retainer box. Tiers are chosen by the on-screen size of the
+ * retainer, scaled by how much of it is actually inside the culling rect.
+ */
+USTRUCT(BlueprintType)
+struct FUIRetainerBoxLODTier
+{
+	GENERATED_BODY()
+
+	/**
+	 * The largest effective on-screen size (in pixels, along the longest axis) this tier applies to.
+	 * The effective size is the render size scaled by the square root of the visible fraction of the retainer,
+	 * so a retainer half off screen counts like one with half the area.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = LOD, meta = (UIMin = 0, ClampMin = 0))
+	float MaxScreenSize = 0.f;
+
+	/**
+	 * Multiplies the PhaseCount of the retainer while this tier is active.
+	 * A multiplier of 4 on a retainer drawing every other frame makes it draw every 8th frame.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = LOD, meta = (UIMin = 1, ClampMin = 1))
+	int32 RefreshIntervalMultiplier = 1;
+
+	/**
+	 * Scale applied to the render target resolution while this tier is active.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = LOD, meta = (UIMin = 0.1, ClampMin = 0.1, UIMax = 1, ClampMax = 1))
+	float ResolutionScale = 1.f;
+};
+
+/**
+ * A single draw element captured from a retainer drawn without a renderer, such as under NullRHI.
+ */
+USTRUCT(BlueprintType)
+struct FUIRetainerBoxCapturedElement
+{
+	GENERATED_BODY()
+
+	/** The FSlateDrawElement::EElementType of the element. */
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	int32 ElementType = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	int32 Layer = 0;
+
+	/** Position of the element relative to the retained surface. */
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	FVector2D Position = FVector2D::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	FVector2D Size = FVector2D::ZeroVector;
+};
+
+/**
+ * The contents of a retained surface read back from the GPU.  Headless readbacks contain the draw elements
+ * of the surface rather than pixels.
+ */
+USTRUCT(BlueprintType)
+struct FUIRetainerBoxReadbackResult
+{
+	GENERATED_BODY()
+
+	/** True if this readback came from a headless draw and only contains elements. */
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	bool bHeadless = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	/** The pixels of the surface, row by row.  Empty if the readback failed or was headless. */
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	TArray<FColor> Pixels;
+
+	UPROPERTY(BlueprintReadOnly, Category = Readback)
+	TArray<FUIRetainerBoxCapturedElement> Elements;
+};
+
+/**
+ * Counts of the invalidations a retainer box has received from its content, split by whether they could
+ * change the retained pixels.
+ */
+USTRUCT(BlueprintType)
+struct FUIRetainerBoxInvalidationStats
+{
+	GENERATED_BODY()
+
+	/** Invalidations that requested a redraw. */
+	UPROPERTY(BlueprintReadOnly, Category = Invalidation)
+	int32 Accepted = 0;
+
+	/** Invalidations ignored because the widget was under a hidden widget or an inactive switcher slot. */
+	UPROPERTY(BlueprintReadOnly, Category = Invalidation)
+	int32 FilteredHidden = 0;
+};
+
+/**
+ * Refresh settings applied to a whole retainer group at once, such as one profile for the active screen
+ * and another for screens in the background.
+ */
+USTRUCT(BlueprintType)
+struct FUIRetainerGroupProfile
+{
+	GENERATED_BODY()
+
+	/** Frames between redraws of each member, 0 to leave members on their own phase settings. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Group, meta = (UIMin = 0, ClampMin = 0))
+	int32 PhaseCount = 0;
+
+	/** Members allowed to redraw each frame, 0 for unlimited. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Group, meta = (UIMin = 0, ClampMin = 0))
+	int32 MaxRedrawsPerFrame = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Group)
+	bool bPaused = false;
+};
+
+/**
+ * The cost of keeping an evicted retained surface in system memory, and of bringing it back.
+ */
+USTRUCT(BlueprintType)
+struct FUIRetainerBoxEvictionStats
+{
+	GENERATED_BODY()
+
+	/** Bytes the surface takes as a render target. */
+	UPROPERTY(BlueprintReadOnly, Category = Eviction)
+	int32 UncompressedBytes = 0;
+
+	/** Bytes the surface takes compressed in system memory. */
+	UPROPERTY(BlueprintReadOnly, Category = Eviction)
+	int32 CompressedBytes = 0;
+
+	/** How long compressing the surface took on a worker thread, in milliseconds. */
+	UPROPERTY(BlueprintReadOnly, Category = Eviction)
+	float CompressMs = 0.f;
+
+	/** How long the last restore took from the retainer being shown until the surface was uploaded, in milliseconds. */
+	UPROPERTY(BlueprintReadOnly, Category = Eviction)
+	float RestoreMs = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = Eviction)
+	int32 RestoreCount = 0;
+};
+
+/** Saved with a baked retainer surface, describing how it was baked. */
+UCLASS()
+class UI_API UUIRetainerBoxBakeData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	/** The DPI scale the surface was baked at, the baked pixels divided by it give the size in slate units. */
+	UPROPERTY()
+	float BakeScale = 1.f;
 };
\ No newline at end of file
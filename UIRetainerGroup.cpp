@@ -0,0 +1,73 @@
+#include "UIRetainerGroup.h"
+#include "UObject/Package.h"
+
+TMap<FName, UUIRetainerGroup*> UUIRetainerGroup::NamedGroups;
+
+UUIRetainerGroup::UUIRetainerGroup(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, State(MakeShared<FUIRetainerGroupState>())
+{
+}
+
+UUIRetainerGroup* UUIRetainerGroup::CreateRetainerGroup(UObject* Outer)
+{
+	return NewObject<UUIRetainerGroup>(Outer ? Outer : GetTransientPackage());
+}
+
+UUIRetainerGroup* UUIRetainerGroup::FindOrCreateNamedGroup(FName GroupName)
+{
+	if (UUIRetainerGroup* ExistingGroup = NamedGroups.FindRef(GroupName))
+	{
+		return ExistingGroup;
+	}
+
+	// Named groups are rooted, a profile applied while no retainer box is in the group has to still be
+	// there once one joins.
+	UUIRetainerGroup* NewGroup = NewObject<UUIRetainerGroup>(GetTransientPackage());
+	NewGroup->AddToRoot();
+	NamedGroups.Add(GroupName, NewGroup);
+
+	return NewGroup;
+}
+
+void UUIRetainerGroup::SetRefreshRate(int32 PhaseCount)
+{
+	State->PhaseCount = FMath::Max(PhaseCount, 0);
+}
+
+void UUIRetainerGroup::Pause()
+{
+	State->bPaused = true;
+}
+
+void UUIRetainerGroup::Resume()
+{
+	State->bPaused = false;
+}
+
+bool UUIRetainerGroup::IsPaused() const
+{
+	return State->bPaused;
+}
+
+void UUIRetainerGroup::RequestRenderAll()
+{
+	State->RequestRenderAll();
+}
+
+void UUIRetainerGroup::SetRedrawBudget(int32 MaxRedrawsPerFrame)
+{
+	State->MaxWorkPerFrame = FMath::Max(MaxRedrawsPerFrame, 0);
+}
+
+void UUIRetainerGroup::ApplyProfile(const FUIRetainerGroupProfile& Profile)
+{
+	SetRefreshRate(Profile.PhaseCount);
+	SetRedrawBudget(Profile.MaxRedrawsPerFrame);
+	State->bPaused = Profile.bPaused;
+}
+
+int32 UUIRetainerGroup::GetNumMembers() const
+{
+	return State->GetNumMembers();
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "UIRetainerBoxTypes.h"
+#include "UIRetainerGroupState.h"
+#include "UIRetainerGroup.generated.h"
+
+/**
+ * A group of retainer boxes controlled together.  Refresh rate, pausing and the redraw budget apply to every
+ * member at once, so whole screens can switch between refresh profiles without touching each retainer.
+ */
+UCLASS(BlueprintType)
+class UI_API UUIRetainerGroup : public UObject
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	/** Creates a new, empty group. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	static UUIRetainerGroup* CreateRetainerGroup(UObject* Outer);
+
+	/** Finds the group with the given name, creating it if there isn't one.  Named groups are never destroyed. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	static UUIRetainerGroup* FindOrCreateNamedGroup(FName GroupName);
+
+	/**
+	 * Makes every member redraw once every PhaseCount frames, spread across the phases.  0 returns members
+	 * to their own phase settings.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void SetRefreshRate(int32 PhaseCount);
+
+	/** Stops every member redrawing, anything requested while paused is drawn on resume. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void Pause();
+
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void Resume();
+
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	bool IsPaused() const;
+
+	/** Requests a redraw of every member. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void RequestRenderAll();
+
+	/** Limits how many members redraw each frame, 0 for unlimited. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void SetRedrawBudget(int32 MaxRedrawsPerFrame);
+
+	/** Applies the refresh rate, budget and paused state of the profile together. */
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	void ApplyProfile(const FUIRetainerGroupProfile& Profile);
+
+	UFUNCTION(BlueprintCallable, Category = "Retainer|Group")
+	int32 GetNumMembers() const;
+
+	/** Gets the state shared with the Slate retainers of the group. */
+	TSharedRef<FUIRetainerGroupState> GetState() const { return State.ToSharedRef(); }
+
+private:
+	TSharedPtr<FUIRetainerGroupState> State;
+
+	static TMap<FName, UUIRetainerGroup*> NamedGroups;
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "UIRetainerGroupState.h"
+#include "SUIRetainerBoxWidget.h"
+
+int32 FUIRetainerGroupState::AddMember(const TSharedRef<SUIRetainerBoxWidget>& Member)
+{
+	Members.Add(Member);
+	return NextSlot++;
+}
+
+void FUIRetainerGroupState::RemoveMember(const SUIRetainerBoxWidget* Member)
+{
+	Members.RemoveAll([Member](const TWeakPtr<SUIRetainerBoxWidget>& WeakMember)
+	{
+		return !WeakMember.IsValid() || WeakMember.Pin().Get() == Member;
+	});
+}
+
+void FUIRetainerGroupState::RequestRenderAll()
+{
+	for (int32 Index = Members.Num() - 1; Index >= 0; Index--)
+	{
+		if (TSharedPtr<SUIRetainerBoxWidget> Member = Members[Index].Pin())
+		{
+			Member->RequestRender();
+		}
+		else
+		{
+			Members.RemoveAtSwap(Index);
+		}
+	}
+}
+
+int32 FUIRetainerGroupState::GetNumMembers() const
+{
+	int32 NumMembers = 0;
+	for (const TWeakPtr<SUIRetainerBoxWidget>& Member : Members)
+	{
+		if (Member.IsValid())
+		{
+			NumMembers++;
+		}
+	}
+	return NumMembers;
+}
\ No newline at end of file
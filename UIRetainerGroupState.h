@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/FrameValue.h"
+
+class SUIRetainerBoxWidget;
+
+/**
+ * Settings and per frame work shared by the retainers of a group.  The retainers pass it to the scheduling
+ * policy every frame, so changing it applies to all of them at once.
+ */
+class UI_API FUIRetainerGroupState
+{
+public:
+	/** Paused members don't redraw, anything requested meanwhile is drawn once they resume. */
+	bool bPaused = false;
+
+	/** Phase count every member redraws with, spread across the phases.  0 leaves members on their own. */
+	int32 PhaseCount = 0;
+
+	/** Members allowed to redraw each frame before the rest are deferred, 0 for unlimited. */
+	int32 MaxWorkPerFrame = 0;
+
+	/** Adds a retainer to the group, returning the slot used to spread it across the phases. */
+	int32 AddMember(const TSharedRef<SUIRetainerBoxWidget>& Member);
+
+	void RemoveMember(const SUIRetainerBoxWidget* Member);
+
+	/** Requests a redraw of every member. */
+	void RequestRenderAll();
+
+	int32 GetNumMembers() const;
+
+	/** Gets how many members have redrawn this frame. */
+	int32 GetWorkThisFrame() const
+	{
+		return WorkThisFrame.TryGetValue(0);
+	}
+
+	/** Counts a member redraw against this frame's budget. */
+	void AddWork()
+	{
+		WorkThisFrame = WorkThisFrame.TryGetValue(0) + 1;
+	}
+
+private:
+	TArray<TWeakPtr<SUIRetainerBoxWidget>> Members;
+	int32 NextSlot = 0;
+	TFrameValue<int32> WorkThisFrame;
+};
\ No newline at end of file
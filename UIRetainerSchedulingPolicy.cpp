@@ -0,0 +1,89 @@
+#include "UIRetainerSchedulingPolicy.h"
+
+FUIRetainerSchedulingPolicy::FUIRetainerSchedulingPolicy(const FUIRetainerSchedulingConfig& InConfig)
+	: Config(InConfig)
+{
+}
+
+FUIRetainerScheduleResult FUIRetainerSchedulingPolicy::Evaluate(const FUIRetainerScheduleInput& Input, FUIRetainerScheduleState& State) const
+{
+	FUIRetainerScheduleResult Result;
+
+	// Completely culled retainers keep any pending request so they catch up once they are visible again.
+	if (Input.bCulled)
+	{
+		Result.Decision = EUIRetainerRedrawDecision::Culled;
+		return Result;
+	}
+
+	// Occluded ones too, they show again as soon as whatever covers them goes away.
+	if (Input.bOccluded)
+	{
+		Result.Decision = EUIRetainerRedrawDecision::Occluded;
+		return Result;
+	}
+
+	// Paused groups hold their members the same way, so pending requests are drawn on resume.
+	if (Input.bGroupPaused)
+	{
+		Result.Decision = EUIRetainerRedrawDecision::Paused;
+		return Result;
+	}
+
+	// A group refresh rate overrides the retainer's own, with the members spread across the phases.
+	const bool bGroupPhase = Input.GroupPhaseCount > 0;
+	const int32_t Phase = bGroupPhase ? Input.GroupSlot % Input.GroupPhaseCount : Input.Phase;
+	const int32_t OwnPhaseCount = bGroupPhase ? Input.GroupPhaseCount : Input.PhaseCount;
+
+	const uint64_t PhaseCount = static_cast<uint64_t>(OwnPhaseCount > 1 ? OwnPhaseCount : 1)
+		* static_cast<uint64_t>(Input.RefreshIntervalMultiplier > 1 ? Input.RefreshIntervalMultiplier : 1)
+		* static_cast<uint64_t>(Config.PhaseCountMultiplier > 1 ? Config.PhaseCountMultiplier : 1);
+
+	if (State.bRenderRequested)
+	{
+		Result.Reason = EUIRetainerRedrawReason::Requested;
+	}
+
+	if (Input.bRenderOnPhase)
+	{
+		if (State.LastDrawnFrame != Input.Frame && (Input.Frame % PhaseCount) == static_cast<uint64_t>(Phase))
+		{
+			State.bRenderRequested = true;
+			Result.Reason = EUIRetainerRedrawReason::Phase;
+		}
+	}
+
+	if (Input.Width != State.PreviousWidth || Input.Height != State.PreviousHeight)
+	{
+		State.PreviousWidth = Input.Width;
+		State.PreviousHeight = Input.Height;
+		State.bRenderRequested = true;
+		Result.Reason = EUIRetainerRedrawReason::Resized;
+	}
+
+	if (!State.bRenderRequested)
+	{
+		Result.Decision = EUIRetainerRedrawDecision::Skip;
+		return Result;
+	}
+
+	// The request stays pending so the retainer is redrawn on the next frame with budget left.
+	// The frame budget only defers once it has been exceeded, as it always has, while a group budget of N allows exactly N redraws.
+	const bool bOverBudget = Config.MaxWorkPerFrame > 0 && Input.WorkThisFrame > Config.MaxWorkPerFrame;
+	const bool bOverGroupBudget = Input.GroupMaxWorkPerFrame > 0 && Input.GroupWorkThisFrame >= Input.GroupMaxWorkPerFrame;
+
+	if (bOverBudget || bOverGroupBudget)
+	{
+		Result.Decision = EUIRetainerRedrawDecision::DeferredByBudget;
+		return Result;
+	}
+
+	State.LastDrawnFrame = Input.Frame;
+	Result.Decision = EUIRetainerRedrawDecision::Redraw;
+	return Result;
+}
+
+void FUIRetainerSchedulingPolicy::OnRedrawn(FUIRetainerScheduleState& State)
+{
+	State.bRenderRequested = false;
+}
\ No newline at end of file
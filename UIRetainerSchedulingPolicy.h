@@ -0,0 +1,125 @@
+#pragma once
+
+// The scheduling rules of retainer boxes, kept free of any engine types so they can be tested and replayed
+// against recorded traces outside of a running Slate application.
+
+#include <cstdint>
+
+/** What a retainer does with its retained surface on a given frame. */
+enum class EUIRetainerRedrawDecision : uint8_t
+{
+	/** The retained content is redrawn. */
+	Redraw,
+	/** Nothing asked for a redraw, the last surface is reused. */
+	Skip,
+	/** A redraw may be needed, but the per frame retainer budget has already been used up. */
+	DeferredByBudget,
+	/** The retainer is entirely off screen, any pending redraw waits until it's visible. */
+	Culled,
+	/** The retainer's group is paused, any pending redraw waits until it resumes. */
+	Paused,
+	/** The retainer is covered by opaque retainers, any pending redraw waits until it's uncovered. */
+	Occluded
+};
+
+/** Why a retainer was redrawn. */
+enum class EUIRetainerRedrawReason : uint8_t
+{
+	None,
+	/** The frame landed on the retainer's phase. */
+	Phase,
+	/** Something requested a redraw, an invalidation, a global invalidate or an explicit request. */
+	Requested,
+	/** The size of the retained surface changed. */
+	Resized
+};
+
+/** Tunables of the scheduling policy. */
+struct FUIRetainerSchedulingConfig
+{
+	/** Retainers redrawn each frame after which the rest are deferred, 0 for unlimited.  One more is still allowed to redraw once it's reached. */
+	int32_t MaxWorkPerFrame = 0;
+
+	/** Multiplies the phase count of every retainer. */
+	int32_t PhaseCountMultiplier = 1;
+};
+
+/** Everything about a retainer the policy needs to know on the frame it is painted. */
+struct FUIRetainerScheduleInput
+{
+	uint64_t Frame = 0;
+
+	bool bRenderOnPhase = true;
+	int32_t Phase = 0;
+	int32_t PhaseCount = 1;
+
+	/** Multiplies the phase count, e.g. for the screen size LOD tier the retainer is in. */
+	int32_t RefreshIntervalMultiplier = 1;
+
+	/** True if no part of the retainer is on screen. */
+	bool bCulled = false;
+
+	/** True if the retainer is entirely covered by opaque retainers painted after it. */
+	bool bOccluded = false;
+
+	/** Size of the retained surface in pixels. */
+	float Width = 0.f;
+	float Height = 0.f;
+
+	/** How many retainers have already been redrawn this frame. */
+	int32_t WorkThisFrame = 0;
+
+	/** Phase count shared by the retainer's group, which spreads its members across the phases by slot.  0 leaves the retainer on its own phase. */
+	int32_t GroupPhaseCount = 0;
+	int32_t GroupSlot = 0;
+
+	bool bGroupPaused = false;
+
+	/** Members of the retainer's group allowed to redraw each frame, 0 for unlimited, and how many already have. */
+	int32_t GroupMaxWorkPerFrame = 0;
+	int32_t GroupWorkThisFrame = 0;
+};
+
+/** The scheduling state each retainer carries between frames. */
+struct FUIRetainerScheduleState
+{
+	/** A redraw has been asked for and hasn't happened yet. */
+	bool bRenderRequested = true;
+
+	/** The last frame the retainer decided to redraw on. */
+	uint64_t LastDrawnFrame = 0;
+
+	float PreviousWidth = 0.f;
+	float PreviousHeight = 0.f;
+};
+
+struct FUIRetainerScheduleResult
+{
+	EUIRetainerRedrawDecision Decision = EUIRetainerRedrawDecision::Skip;
+	EUIRetainerRedrawReason Reason = EUIRetainerRedrawReason::None;
+};
+
+/**
+ * Decides when a retainer redraws: on its phase, when requested and when its size changes, within the
+ * per frame budgets shared by all retainers and by the members of its group.
+ */
+class FUIRetainerSchedulingPolicy
+{
+public:
+	FUIRetainerSchedulingPolicy() = default;
+	explicit FUIRetainerSchedulingPolicy(const FUIRetainerSchedulingConfig& InConfig);
+
+	/**
+	 * Evaluates a retainer for the frame, updating its state.  If the decision is to redraw the caller is
+	 * expected to draw and then call OnRedrawn.
+	 */
+	FUIRetainerScheduleResult Evaluate(const FUIRetainerScheduleInput& Input, FUIRetainerScheduleState& State) const;
+
+	/** Marks the pending request as handled once the retainer has actually been drawn. */
+	static void OnRedrawn(FUIRetainerScheduleState& State);
+
+	const FUIRetainerSchedulingConfig& GetConfig() const { return Config; }
+
+private:
+	FUIRetainerSchedulingConfig Config;
+};
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "UIRetainerTimeline.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUIRetainerTimeline, Log, All);
+
+bool FUIRetainerTimeline::bIsEnabled = false;
+
+static FAutoConsoleCommand UIRetainerTimelineStartCommand(
+	TEXT("Slate.UIRetainerTimeline.Start"),
+	TEXT("Starts capturing a timeline of retainer redraws. Optionally takes the file to write when stopped."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0
+			? Args[0]
+			: FPaths::ProfilingDir() / FString::Printf(TEXT("UIRetainerTimeline-%s.json"), *FDateTime::Now().ToString());
+
+		FUIRetainerTimeline::Get().Start(FilePath);
+	}));
+
+static FAutoConsoleCommand UIRetainerTimelineStopCommand(
+	TEXT("Slate.UIRetainerTimeline.Stop"),
+	TEXT("Stops capturing the retainer timeline and writes it out."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FUIRetainerTimeline::Get().Stop();
+	}));
+
+FUIRetainerTimeline& FUIRetainerTimeline::Get()
+{
+	static FUIRetainerTimeline Timeline;
+	return Timeline;
+}
+
+void FUIRetainerTimeline::Start(const FString& FilePath)
+{
+	Stop();
+
+	OutputFilePath = FilePath;
+	Events.Reset();
+	RetainerTrackIds.Reset();
+	NextTrackId = 1;
+
+	bIsEnabled = true;
+	UE_LOG(LogUIRetainerTimeline, Display, TEXT("Capturing retainer timeline, it will be written to '%s'."), *OutputFilePath);
+}
+
+void FUIRetainerTimeline::Stop()
+{
+	if (!bIsEnabled)
+	{
+		return;
+	}
+
+	bIsEnabled = false;
+
+	// Every retainer gets its own track, named after its stat.
+	TSet<int32> NamedTracks;
+	FString Json = TEXT("{\"traceEvents\":[\n");
+
+	for (const FTrackedEvent& TrackedEvent : Events)
+	{
+		const FUIRetainerTimelineEvent& Event = TrackedEvent.Event;
+		const int32 TrackId = TrackedEvent.TrackId;
+
+		if (!NamedTracks.Contains(TrackId))
+		{
+			NamedTracks.Add(TrackId);
+			Json += FString::Printf(TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n"),
+				TrackId, Event.StatName.IsNone() ? *FString::Printf(TEXT("Unnamed Retainer %d"), TrackId) : *Event.StatName.ToString().ReplaceCharWithEscapedChar());
+		}
+
+		const double DurationMs = Event.PrepassMs + Event.PaintMs;
+
+		// Redraws that painted are spans covering their cost, everything else is an instant.
+		const bool bRedrawn = Event.Result.Decision == EUIRetainerRedrawDecision::Redraw && Event.bPainted;
+
+		Json += FString::Printf(TEXT("{\"name\":\"%s\",\"cat\":\"UIRetainer\",\"ph\":\"%s\",%s\"ts\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{\"frame\":%llu,\"reason\":\"%s\",\"width\":%.0f,\"height\":%.0f,\"prepassMs\":%.4f,\"paintMs\":%.4f,\"deferredRenderThread\":%s}},\n"),
+			Event.Result.Decision == EUIRetainerRedrawDecision::Redraw && !Event.bPainted ? TEXT("NotDrawn") : GetDecisionName(Event.Result.Decision),
+			bRedrawn ? TEXT("X") : TEXT("i"),
+			bRedrawn ? *FString::Printf(TEXT("\"dur\":%.3f,"), DurationMs * 1000.0) : TEXT("\"s\":\"t\","),
+			Event.StartTime * 1000000.0,
+			TrackId,
+			Event.Frame,
+			GetReasonName(Event.Result.Reason),
+			Event.RenderSize.X,
+			Event.RenderSize.Y,
+			Event.PrepassMs,
+			Event.PaintMs,
+			Event.bDeferredRenderThreadWork ? TEXT("true") : TEXT("false"));
+	}
+
+	Json.RemoveFromEnd(TEXT(",\n"));
+	Json += TEXT("\n]}\n");
+
+	if (FFileHelper::SaveStringToFile(Json, *OutputFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogUIRetainerTimeline, Display, TEXT("Wrote %d retainer timeline events to '%s'."), Events.Num(), *OutputFilePath);
+	}
+	else
+	{
+		UE_LOG(LogUIRetainerTimeline, Error, TEXT("Failed to write the retainer timeline to '%s'."), *OutputFilePath);
+	}
+
+	Events.Empty();
+	RetainerTrackIds.Empty();
+}
+
+void FUIRetainerTimeline::Emit(const FUIRetainerTimelineEvent& Event)
+{
+	if (bIsEnabled)
+	{
+		// Tracks are keyed by the retainer itself, stat names aren't unique and are only set with stats enabled.
+		int32* ExistingTrackId = RetainerTrackIds.Find(Event.Retainer);
+		const int32 TrackId = ExistingTrackId ? *ExistingTrackId : RetainerTrackIds.Add(Event.Retainer, NextTrackId++);
+
+		FTrackedEvent TrackedEvent;
+		TrackedEvent.Event = Event;
+		TrackedEvent.TrackId = TrackId;
+		Events.Add(TrackedEvent);
+	}
+}
+
+void FUIRetainerTimeline::ForgetRetainer(const void* Retainer)
+{
+	RetainerTrackIds.Remove(Retainer);
+}
+
+const TCHAR* FUIRetainerTimeline::GetDecisionName(EUIRetainerRedrawDecision Decision)
+{
+	switch (Decision)
+	{
+	case EUIRetainerRedrawDecision::Redraw: return TEXT("Redrawn");
+	case EUIRetainerRedrawDecision::Skip: return TEXT("Skipped");
+	case EUIRetainerRedrawDecision::DeferredByBudget: return TEXT("DeferredByBudget");
+	case EUIRetainerRedrawDecision::Culled: return TEXT("Culled");
+	case EUIRetainerRedrawDecision::Paused: return TEXT("Paused");
+	case EUIRetainerRedrawDecision::Occluded: return TEXT("Occluded");
+	}
+
+	return TEXT("Unknown");
+}
+
+const TCHAR* FUIRetainerTimeline::GetReasonName(EUIRetainerRedrawReason Reason)
+{
+	switch (Reason)
+	{
+	case EUIRetainerRedrawReason::None: return TEXT("None");
+	case EUIRetainerRedrawReason::Phase: return TEXT("Phase");
+	case EUIRetainerRedrawReason::Requested: return TEXT("Requested");
+	case EUIRetainerRedrawReason::Resized: return TEXT("Resized");
+	}
+
+	return TEXT("Unknown");
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UIRetainerSchedulingPolicy.h"
+
+/** One retainer on one frame, as shown on the timeline. */
+struct FUIRetainerTimelineEvent
+{
+	/** The retainer the event is for, each one gets its own track. */
+	const void* Retainer = nullptr;
+	FName StatName;
+	uint64 Frame = 0;
+
+	/** When the retainer was evaluated, in FPlatformTime::Seconds. */
+	double StartTime = 0.0;
+
+	FUIRetainerScheduleResult Result;
+
+	/** False if the retainer was told to redraw but bailed out without drawing. */
+	bool bPainted = false;
+
+	FVector2D RenderSize = FVector2D::ZeroVector;
+
+	double PrepassMs = 0.0;
+	double PaintMs = 0.0;
+
+	/** True if the render thread work of the redraw was deferred to the end of the frame. */
+	bool bDeferredRenderThreadWork = false;
+};
+
+/**
+ * A trace channel emitting one event per retainer per frame with its redraw decision and timings, written
+ * in the Chrome trace event format so it can be viewed in chrome://tracing or Perfetto.  Timestamps come
+ * from FPlatformTime::Seconds so they can be lined up with other captures of the same session.
+ *
+ * Start and stop the channel with the Slate.UIRetainerTimeline.Start [File] and Slate.UIRetainerTimeline.Stop
+ * console commands.  While it's off the only cost is checking IsEnabled.
+ */
+class UI_API FUIRetainerTimeline
+{
+public:
+	static FUIRetainerTimeline& Get();
+
+	static bool IsEnabled() { return bIsEnabled; }
+
+	/** Starts capturing events, they are written to the file when the channel is stopped. */
+	void Start(const FString& FilePath);
+
+	void Stop();
+
+	void Emit(const FUIRetainerTimelineEvent& Event);
+
+	/** Forgets a destroyed retainer so a new one at the same address gets its own track. */
+	void ForgetRetainer(const void* Retainer);
+
+private:
+	struct FTrackedEvent
+	{
+		FUIRetainerTimelineEvent Event;
+		int32 TrackId = 0;
+	};
+
+	static const TCHAR* GetDecisionName(EUIRetainerRedrawDecision Decision);
+	static const TCHAR* GetReasonName(EUIRetainerRedrawReason Reason);
+
+	static bool bIsEnabled;
+
+	FString OutputFilePath;
+	TArray<FTrackedEvent> Events;
+
+	TMap<const void*, int32> RetainerTrackIds;
+	int32 NextTrackId = 1;
+};
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "UIRetainerTraceRecorder.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUIRetainerTrace, Log, All);
+
+bool FUIRetainerTraceRecorder::bIsRecording = false;
+
+static FAutoConsoleCommand UIRetainerTraceStartCommand(
+	TEXT("Slate.UIRetainerTrace.Start"),
+	TEXT("Starts recording retainer scheduling to a trace file for offline replay. Optionally takes the file to write."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0
+			? Args[0]
+			: FPaths::ProfilingDir() / FString::Printf(TEXT("UIRetainerTrace-%s.txt"), *FDateTime::Now().ToString());
+
+		FUIRetainerTraceRecorder::Get().Start(FilePath);
+	}));
+
+static FAutoConsoleCommand UIRetainerTraceStopCommand(
+	TEXT("Slate.UIRetainerTrace.Stop"),
+	TEXT("Stops recording retainer scheduling."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FUIRetainerTraceRecorder::Get().Stop();
+	}));
+
+FUIRetainerTraceRecorder& FUIRetainerTraceRecorder::Get()
+{
+	static FUIRetainerTraceRecorder Recorder;
+	return Recorder;
+}
+
+bool FUIRetainerTraceRecorder::Start(const FString& FilePath)
+{
+	Stop();
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogUIRetainerTrace, Error, TEXT("Failed to open '%s' for writing."), *FilePath);
+		return false;
+	}
+
+	RetainerIds.Reset();
+	NextRetainerId = 0;
+	GroupIds.Reset();
+	LastRecordedFrame = MAX_uint64;
+
+	WriteLine(TEXT("UIRetainerTrace 4"));
+
+	bIsRecording = true;
+	UE_LOG(LogUIRetainerTrace, Display, TEXT("Recording retainer trace to '%s'."), *FilePath);
+	return true;
+}
+
+void FUIRetainerTraceRecorder::Stop()
+{
+	if (bIsRecording)
+	{
+		bIsRecording = false;
+
+		Writer->Close();
+		Writer.Reset();
+
+		UE_LOG(LogUIRetainerTrace, Display, TEXT("Stopped recording retainer trace, %u retainers recorded."), NextRetainerId);
+	}
+}
+
+void FUIRetainerTraceRecorder::RecordEvent(const void* Retainer, const void* Group, FName RetainerName, const FUIRetainerScheduleInput& Input, bool bRequested, const FUIRetainerScheduleResult& Result, bool bPainted, double PaintCostMs)
+{
+	if (!bIsRecording)
+	{
+		return;
+	}
+
+	uint32* ExistingId = RetainerIds.Find(Retainer);
+	const uint32 RetainerId = ExistingId ? *ExistingId : NextRetainerId++;
+
+	if (!ExistingId)
+	{
+		RetainerIds.Add(Retainer, RetainerId);
+		WriteLine(FString::Printf(TEXT("R %u %s"), RetainerId, RetainerName.IsNone() ? TEXT("Unnamed") : *RetainerName.ToString()));
+	}
+
+	if (Input.Frame != LastRecordedFrame)
+	{
+		LastRecordedFrame = Input.Frame;
+		WriteLine(FString::Printf(TEXT("F %llu"), Input.Frame));
+	}
+
+	uint32 GroupId = 0;
+	if (Group)
+	{
+		uint32* ExistingGroupId = GroupIds.Find(Group);
+		GroupId = ExistingGroupId ? *ExistingGroupId : GroupIds.Add(Group, GroupIds.Num() + 1);
+	}
+
+	WriteLine(FString::Printf(TEXT("E %u %d %d %d %d %d %.2f %.2f %d %d %.4f %d %d %u %d %d %d %d %d"),
+		RetainerId,
+		Input.bRenderOnPhase ? 1 : 0,
+		Input.Phase,
+		Input.PhaseCount,
+		bRequested ? 1 : 0,
+		Input.bCulled ? 1 : 0,
+		Input.Width,
+		Input.Height,
+		static_cast<int32>(Result.Decision),
+		static_cast<int32>(Result.Reason),
+		PaintCostMs,
+		bPainted ? 1 : 0,
+		Input.RefreshIntervalMultiplier,
+		GroupId,
+		Input.GroupPhaseCount,
+		Input.GroupSlot,
+		Input.bGroupPaused ? 1 : 0,
+		Input.GroupMaxWorkPerFrame,
+		Input.bOccluded ? 1 : 0));
+}
+
+void FUIRetainerTraceRecorder::ForgetRetainer(const void* Retainer)
+{
+	RetainerIds.Remove(Retainer);
+}
+
+void FUIRetainerTraceRecorder::WriteLine(const FString& Line)
+{
+	FTCHARToUTF8 Converted(*(Line + TEXT("\n")));
+	Writer->Serialize(const_cast<ANSICHAR*>(Converted.Get()), Converted.Length());
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UIRetainerSchedulingPolicy.h"
+
+/**
+ * Records what each retainer was asked to do every frame it was painted, invalidations, sizes, culling
+ * and paint cost, so the trace can be replayed offline against other scheduling policies.
+ *
+ * Start and stop recording with the Slate.UIRetainerTrace.Start [File] and Slate.UIRetainerTrace.Stop console
+ * commands.  The file format is described in UIRetainerTraceReplay.h.
+ */
+class UI_API FUIRetainerTraceRecorder
+{
+public:
+	static FUIRetainerTraceRecorder& Get();
+
+	static bool IsRecording() { return bIsRecording; }
+
+	/** Starts recording to the given file, stopping any recording in progress. */
+	bool Start(const FString& FilePath);
+
+	void Stop();
+
+	/**
+	 * Records the scheduling of a retainer for the current frame, and whether a redraw actually painted the surface.
+	 * Group is the state shared with the other members of the retainer's group, if it's in one.
+	 */
+	void RecordEvent(const void* Retainer, const void* Group, FName RetainerName, const FUIRetainerScheduleInput& Input, bool bRequested, const FUIRetainerScheduleResult& Result, bool bPainted, double PaintCostMs);
+
+	/** Forgets a destroyed retainer so its address can't be mistaken for a new one. */
+	void ForgetRetainer(const void* Retainer);
+
+private:
+	void WriteLine(const FString& Line);
+
+	static bool bIsRecording;
+
+	TUniquePtr<FArchive> Writer;
+
+	TMap<const void*, uint32> RetainerIds;
+	uint32 NextRetainerId = 0;
+
+	/** Groups are numbered from 1, 0 is no group. */
+	TMap<const void*, uint32> GroupIds;
+
+	uint64 LastRecordedFrame = MAX_uint64;
+};
\ No newline at end of file
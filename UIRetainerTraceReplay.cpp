@@ -0,0 +1,259 @@
+#if defined(UIRETAINER_TRACE_REPLAY_TOOL)
+
+#include "UIRetainerTraceReplay.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+bool FUIRetainerTrace::Load(const std::string& FilePath, std::string& OutError)
+{
+	std::ifstream File(FilePath);
+	if (!File)
+	{
+		OutError = "Failed to open " + FilePath;
+		return false;
+	}
+
+	std::string Line;
+	if (!std::getline(File, Line) || Line.compare(0, 15, "UIRetainerTrace") != 0)
+	{
+		OutError = FilePath + " is not a retainer trace";
+		return false;
+	}
+
+	const int Version = std::atoi(Line.c_str() + 15);
+
+	RetainerNames.clear();
+	Frames.clear();
+	NumGroups = 0;
+
+	int LineNumber = 1;
+	while (std::getline(File, Line))
+	{
+		LineNumber++;
+
+		if (Line.empty())
+		{
+			continue;
+		}
+
+		std::istringstream Stream(Line.substr(1));
+
+		if (Line[0] == 'R')
+		{
+			uint32_t RetainerId = 0;
+			std::string Name;
+			Stream >> RetainerId;
+			std::getline(Stream >> std::ws, Name);
+
+			if (RetainerNames.size() <= RetainerId)
+			{
+				RetainerNames.resize(RetainerId + 1);
+			}
+			RetainerNames[RetainerId] = Name;
+		}
+		else if (Line[0] == 'F')
+		{
+			FUIRetainerTraceFrame Frame;
+			Stream >> Frame.Frame;
+			Frames.push_back(Frame);
+		}
+		else if (Line[0] == 'E' && !Frames.empty())
+		{
+			FUIRetainerTraceEvent Event;
+			int RenderOnPhase = 0;
+			int Requested = 0;
+			int Culled = 0;
+			int Decision = 0;
+			int Reason = 0;
+			int Painted = 0;
+			int GroupPaused = 0;
+			int Occluded = 0;
+
+			Stream >> Event.RetainerId >> RenderOnPhase >> Event.Input.Phase >> Event.Input.PhaseCount >> Requested >> Culled
+				>> Event.Input.Width >> Event.Input.Height >> Decision >> Reason >> Event.PaintCostMs;
+
+			// Older traces only measured the cost of redraws that painted.
+			if (Version >= 2)
+			{
+				Stream >> Painted;
+			}
+			else
+			{
+				Painted = Event.PaintCostMs > 0.0 ? 1 : 0;
+			}
+
+			if (Version >= 3)
+			{
+				Stream >> Event.Input.RefreshIntervalMultiplier >> Event.GroupId >> Event.Input.GroupPhaseCount >> Event.Input.GroupSlot
+					>> GroupPaused >> Event.Input.GroupMaxWorkPerFrame;
+			}
+
+			// Older traces recorded occluded retainers as culled.
+			if (Version >= 4)
+			{
+				Stream >> Occluded;
+			}
+
+			if (!Stream)
+			{
+				OutError = "Malformed event on line " + std::to_string(LineNumber);
+				return false;
+			}
+
+			Event.Input.Frame = Frames.back().Frame;
+			Event.Input.bRenderOnPhase = RenderOnPhase != 0;
+			Event.Input.bCulled = Culled != 0;
+			Event.Input.bOccluded = Occluded != 0;
+			Event.bRequested = Requested != 0;
+			Event.RecordedDecision = static_cast<EUIRetainerRedrawDecision>(Decision);
+			Event.RecordedReason = static_cast<EUIRetainerRedrawReason>(Reason);
+			Event.bPainted = Painted != 0;
+			Event.Input.bGroupPaused = GroupPaused != 0;
+			NumGroups = std::max(NumGroups, Event.GroupId);
+
+			if (RetainerNames.size() <= Event.RetainerId)
+			{
+				RetainerNames.resize(Event.RetainerId + 1);
+			}
+
+			Frames.back().Events.push_back(Event);
+		}
+	}
+
+	return true;
+}
+
+FUIRetainerReplayReport ReplayRetainerTrace(const FUIRetainerTrace& Trace, const FUIRetainerSchedulingPolicy& Policy)
+{
+	const size_t NumRetainers = Trace.RetainerNames.size();
+
+	// Estimate the cost of a redraw from what each retainer was recorded costing.
+	std::vector<double> TotalCostMs(NumRetainers, 0.0);
+	std::vector<uint64_t> CostSamples(NumRetainers, 0);
+	double AllCostMs = 0.0;
+	uint64_t AllCostSamples = 0;
+
+	for (const FUIRetainerTraceFrame& Frame : Trace.Frames)
+	{
+		for (const FUIRetainerTraceEvent& Event : Frame.Events)
+		{
+			if (Event.PaintCostMs > 0.0)
+			{
+				TotalCostMs[Event.RetainerId] += Event.PaintCostMs;
+				CostSamples[Event.RetainerId]++;
+				AllCostMs += Event.PaintCostMs;
+				AllCostSamples++;
+			}
+		}
+	}
+
+	const double FallbackCostMs = AllCostSamples > 0 ? AllCostMs / AllCostSamples : 0.0;
+
+	std::vector<double> EstimatedCostMs(NumRetainers, FallbackCostMs);
+	for (size_t RetainerId = 0; RetainerId < NumRetainers; RetainerId++)
+	{
+		if (CostSamples[RetainerId] > 0)
+		{
+			EstimatedCostMs[RetainerId] = TotalCostMs[RetainerId] / CostSamples[RetainerId];
+		}
+	}
+
+	// Every retainer starts out wanting to draw, same as a freshly constructed one.
+	std::vector<FUIRetainerScheduleState> States(NumRetainers);
+
+	// The frame the oldest request still pending was made on.
+	const uint64_t NoPendingRequest = ~0ull;
+	std::vector<uint64_t> PendingSince(NumRetainers, NoPendingRequest);
+
+	FUIRetainerReplayReport Report;
+	double TotalFrameCostMs = 0.0;
+	double TotalStalenessFrames = 0.0;
+	uint64_t StalenessSamples = 0;
+
+	for (const FUIRetainerTraceFrame& Frame : Trace.Frames)
+	{
+		int32_t WorkThisFrame = 0;
+		std::vector<int32_t> GroupWorkThisFrame(Trace.NumGroups + 1, 0);
+		double FrameCostMs = 0.0;
+
+		for (const FUIRetainerTraceEvent& Event : Frame.Events)
+		{
+			FUIRetainerScheduleState& State = States[Event.RetainerId];
+
+			if (Event.bRequested)
+			{
+				State.bRenderRequested = true;
+				if (PendingSince[Event.RetainerId] == NoPendingRequest)
+				{
+					PendingSince[Event.RetainerId] = Frame.Frame;
+				}
+			}
+
+			FUIRetainerScheduleInput Input = Event.Input;
+			Input.WorkThisFrame = WorkThisFrame;
+			Input.GroupWorkThisFrame = Event.GroupId != 0 ? GroupWorkThisFrame[Event.GroupId] : 0;
+
+			const FUIRetainerScheduleResult Result = Policy.Evaluate(Input, State);
+
+			// A redraw the live session also tried only paints if it did then, otherwise assume it would have.
+			const bool bPainted = Event.RecordedDecision != EUIRetainerRedrawDecision::Redraw || Event.bPainted;
+
+			if (Result.Decision == EUIRetainerRedrawDecision::Redraw && bPainted)
+			{
+				FUIRetainerSchedulingPolicy::OnRedrawn(State);
+
+				WorkThisFrame++;
+				GroupWorkThisFrame[Event.GroupId]++;
+				FrameCostMs += EstimatedCostMs[Event.RetainerId];
+				Report.Redraws++;
+
+				if (PendingSince[Event.RetainerId] != NoPendingRequest)
+				{
+					const uint64_t StalenessFrames = Frame.Frame - PendingSince[Event.RetainerId];
+					TotalStalenessFrames += static_cast<double>(StalenessFrames);
+					StalenessSamples++;
+					Report.MaxStalenessFrames = std::max(Report.MaxStalenessFrames, StalenessFrames);
+					PendingSince[Event.RetainerId] = NoPendingRequest;
+				}
+			}
+			else if (Result.Decision == EUIRetainerRedrawDecision::DeferredByBudget)
+			{
+				Report.DeferredByBudget++;
+			}
+		}
+
+		TotalFrameCostMs += FrameCostMs;
+		Report.PeakFrameCostMs = std::max(Report.PeakFrameCostMs, FrameCostMs);
+	}
+
+	if (!Trace.Frames.empty())
+	{
+		Report.MeanFrameCostMs = TotalFrameCostMs / Trace.Frames.size();
+
+		// Retainers starved for the rest of the trace are the stalest of all, close them out against its last frame.
+		const uint64_t LastFrame = Trace.Frames.back().Frame;
+
+		for (const uint64_t RequestFrame : PendingSince)
+		{
+			if (RequestFrame != NoPendingRequest)
+			{
+				const uint64_t StalenessFrames = LastFrame - RequestFrame;
+				TotalStalenessFrames += static_cast<double>(StalenessFrames);
+				StalenessSamples++;
+				Report.MaxStalenessFrames = std::max(Report.MaxStalenessFrames, StalenessFrames);
+				Report.UnservedRequests++;
+			}
+		}
+	}
+
+	if (StalenessSamples > 0)
+	{
+		Report.MeanStalenessFrames = TotalStalenessFrames / StalenessSamples;
+	}
+
+	return Report;
+}
+
+#endif // UIRETAINER_TRACE_REPLAY_TOOL
\ No newline at end of file
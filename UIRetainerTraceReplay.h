@@ -0,0 +1,80 @@
+#pragma once
+
+// Replays recorded retainer traces against scheduling policies, without any engine dependencies.  Only compiled
+// into the standalone tool, see UIRetainerTraceReplayMain.cpp.
+//
+// Traces are plain text, one record per line:
+//   UIRetainerTrace 4                 header and format version
+//   R <Id> <Name>                     declares a retainer, before its first event
+//   F <Frame>                         starts a frame, the events that follow were painted on it
+//   E <Id> <RenderOnPhase> <Phase> <PhaseCount> <Requested> <Culled> <Width> <Height> <Decision> <Reason> <PaintCostMs> <Painted>
+//     <RefreshIntervalMultiplier> <Group> <GroupPhaseCount> <GroupSlot> <GroupPaused> <GroupMaxWork> <Occluded>
+//                                     a retainer painted this frame, Requested is 1 if anything asked it to redraw since
+//                                     it was last painted, Decision and Reason are what the live policy chose,
+//                                     PaintCostMs is the measured cost of the redraw, 0 if it didn't redraw, and Painted
+//                                     is 0 if a redraw bailed out without drawing.  Group is 0 for retainers outside of
+//                                     a group, the members of each other group share its phase count, pause and budget.
+//                                     Occluded is 1 if the retainer was covered by opaque retainers.  Version 1 traces
+//                                     end after PaintCostMs and version 2 after Painted, and record the phase count
+//                                     with the group and multiplier already applied.  Version 3 traces end after
+//                                     GroupMaxWork, and record occluded retainers as culled.
+
+#include "UIRetainerSchedulingPolicy.h"
+#include <string>
+#include <vector>
+
+struct FUIRetainerTraceEvent
+{
+	uint32_t RetainerId = 0;
+	uint32_t GroupId = 0;
+	FUIRetainerScheduleInput Input;
+	bool bRequested = false;
+	EUIRetainerRedrawDecision RecordedDecision = EUIRetainerRedrawDecision::Skip;
+	EUIRetainerRedrawReason RecordedReason = EUIRetainerRedrawReason::None;
+	double PaintCostMs = 0.0;
+	bool bPainted = false;
+};
+
+struct FUIRetainerTraceFrame
+{
+	uint64_t Frame = 0;
+	std::vector<FUIRetainerTraceEvent> Events;
+};
+
+struct FUIRetainerTrace
+{
+	std::vector<std::string> RetainerNames;
+	std::vector<FUIRetainerTraceFrame> Frames;
+	uint32_t NumGroups = 0;
+
+	/** Loads a trace, returning false and filling in the error if the file can't be read. */
+	bool Load(const std::string& FilePath, std::string& OutError);
+};
+
+/** What a policy did over a whole trace. */
+struct FUIRetainerReplayReport
+{
+	uint64_t Redraws = 0;
+	uint64_t DeferredByBudget = 0;
+
+	/** The most expensive frame, summing the estimated cost of every redraw on it. */
+	double PeakFrameCostMs = 0.0;
+	double MeanFrameCostMs = 0.0;
+
+	/**
+	 * Frames between a retainer being asked to redraw and it actually redrawing.  Requests still pending when the
+	 * trace ends count as stale up to its last frame.
+	 */
+	double MeanStalenessFrames = 0.0;
+	uint64_t MaxStalenessFrames = 0;
+
+	/** Retainers whose request was still pending when the trace ended. */
+	uint64_t UnservedRequests = 0;
+};
+
+/**
+ * Runs the trace through the policy.  The cost of a redraw is estimated from the mean cost the retainer was
+ * recorded redrawing at, since a policy may redraw on frames the live session didn't.  Where the live session
+ * redrew too, the recorded paint result is kept, so redraws that bailed out neither count as work nor clear the request.
+ */
+FUIRetainerReplayReport ReplayRetainerTrace(const FUIRetainerTrace& Trace, const FUIRetainerSchedulingPolicy& Policy);
\ No newline at end of file
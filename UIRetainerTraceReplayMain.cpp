@@ -0,0 +1,105 @@
+// Standalone command line front end for replaying retainer traces.  The replay sources are only compiled when building
+// the tool itself, so none of them end up in the module:
+//   g++ -std=c++14 -DUIRETAINER_TRACE_REPLAY_TOOL=1 UIRetainerSchedulingPolicy.cpp UIRetainerTraceReplay.cpp UIRetainerTraceReplayMain.cpp -o UIRetainerTraceReplay
+//
+// Usage:
+//   UIRetainerTraceReplay <Trace> [Policy...]
+// where each policy is a comma separated list of settings, e.g. "budget=4,phase=2" for at most 4 redraws per frame
+// and every retainer's phase count doubled.  With no policies the default policy is replayed.
+
+#if defined(UIRETAINER_TRACE_REPLAY_TOOL)
+
+#include "UIRetainerTraceReplay.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+static bool ParsePolicy(const std::string& Description, FUIRetainerSchedulingConfig& OutConfig)
+{
+	std::istringstream Stream(Description);
+	std::string Setting;
+
+	while (std::getline(Stream, Setting, ','))
+	{
+		const size_t Separator = Setting.find('=');
+		if (Separator == std::string::npos)
+		{
+			return false;
+		}
+
+		const std::string Name = Setting.substr(0, Separator);
+		const int Value = std::atoi(Setting.c_str() + Separator + 1);
+
+		if (Name == "budget")
+		{
+			OutConfig.MaxWorkPerFrame = Value;
+		}
+		else if (Name == "phase")
+		{
+			OutConfig.PhaseCountMultiplier = Value;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int ArgC, char* ArgV[])
+{
+	if (ArgC < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <Trace> [budget=N,phase=N ...]\n", ArgV[0]);
+		return 1;
+	}
+
+	FUIRetainerTrace Trace;
+	std::string Error;
+	if (!Trace.Load(ArgV[1], Error))
+	{
+		std::fprintf(stderr, "%s\n", Error.c_str());
+		return 1;
+	}
+
+	std::vector<std::string> Policies;
+	for (int ArgIndex = 2; ArgIndex < ArgC; ArgIndex++)
+	{
+		Policies.push_back(ArgV[ArgIndex]);
+	}
+
+	if (Policies.empty())
+	{
+		Policies.push_back("budget=0");
+	}
+
+	std::printf("%zu retainers over %zu frames\n", Trace.RetainerNames.size(), Trace.Frames.size());
+	std::printf("%-24s %10s %10s %12s %12s %14s %14s %10s\n", "Policy", "Redraws", "Deferred", "PeakMs", "MeanMs", "MeanStaleness", "MaxStaleness", "Unserved");
+
+	for (const std::string& PolicyDescription : Policies)
+	{
+		FUIRetainerSchedulingConfig Config;
+		if (!ParsePolicy(PolicyDescription, Config))
+		{
+			std::fprintf(stderr, "Invalid policy '%s'\n", PolicyDescription.c_str());
+			return 1;
+		}
+
+		const FUIRetainerReplayReport Report = ReplayRetainerTrace(Trace, FUIRetainerSchedulingPolicy(Config));
+
+		std::printf("%-24s %10llu %10llu %12.3f %12.3f %14.2f %14llu %10llu\n",
+			PolicyDescription.c_str(),
+			static_cast<unsigned long long>(Report.Redraws),
+			static_cast<unsigned long long>(Report.DeferredByBudget),
+			Report.PeakFrameCostMs,
+			Report.MeanFrameCostMs,
+			Report.MeanStalenessFrames,
+			static_cast<unsigned long long>(Report.MaxStalenessFrames),
+			static_cast<unsigned long long>(Report.UnservedRequests));
+	}
+
+	return 0;
+}
+
+#endif // UIRETAINER_TRACE_REPLAY_TOOL
\ No newline at end of file